@@ -0,0 +1,34 @@
+# Author: Colin Weber (webe1077@umn.edu)
+# Date: 16 October 2026
+# Purpose: To build the compiled CONVENIENT tools (e.g. the 
+# NUISANCE->CONVENIENT converter) against the ROOT that is currently set 
+# up. This file is written in the style of build_genie_gpvm.sh.
+
+# Command: source build_convenient_tools_gpvm.sh
+
+# Exports
+#	CONVENIENT_BUILD_DIR
+#		The directory the tools are built in
+
+# Outputs
+#	$CONVENIENT_BIN_DIR
+#		The directory containing the compiled executables. It is set in 
+#		global_vars.sh.
+
+
+#!/bin/bash
+
+echo "Building CONVENIENT tools..."
+
+# Set the build directory
+export CONVENIENT_BUILD_DIR=$CONVENIENT_DIR/build
+mkdir -p $CONVENIENT_BUILD_DIR
+
+# Configure and build. CMake finds ROOT through the ROOT that is set up.
+cd $CONVENIENT_BUILD_DIR
+cmake $CONVENIENT_DIR
+make -j$(nproc)
+
+# Cd back into this directory
+cd $CONVENIENT_GEN_BUILD_DIR
+echo "DONE!"
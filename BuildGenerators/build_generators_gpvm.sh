@@ -12,6 +12,9 @@
 #	build_nuisance_GENIEv3_00_06_nuwro_neut_gpvm.sh:
 #		Builds nuisance against GENIE v3_00_06, with options for building 
 #		NuWro and NEUT as well.
+#	build_convenient_tools_gpvm.sh:
+#		Builds the compiled CONVENIENT tools, such as the 
+#		NUISANCE->CONVENIENT converter.
 #	add_to_root_macropath.sh:
 #		Adds necessary directories to ROOT MacroPath
 
@@ -53,4 +56,6 @@ source build_nuisance_GENIEv3_04_00_nuwro_neut_gpvm.sh --NuWro $nuwro_opt --NEUT
 
 source build_nuisance_GENIEv3_00_06_nuwro_neut_gpvm.sh --NuWro $nuwro_opt --NEUT $neut_opt
 
+source build_convenient_tools_gpvm.sh
+
 source add_to_root_macropath.sh
@@ -46,6 +46,9 @@
 # She-bang!
 #!/bin/bash
 
+# For timed_stage
+source $CONVENIENT_DIR/documentation_generation_scripts/telemetry.sh
+
 # Read the inputs
 genie_config=$2
 genie_flux_file=$4
@@ -54,6 +57,10 @@ genie_seed=$8
 genie_target=${10}
 genie_rel_target=${genie_target/$CONVENIENT_TAR_DIR\//}
 
+# The events and seed of this shard, if any (see run_shard in run.sh)
+genie_n_events=${CONVENIENT_SHARD_EVENTS:-$N_EVENTS}
+genie_generator_seed=${CONVENIENT_SHARD_SEED:-$genie_seed}
+
 # Tell us what tune we're on
 echo "Generating and processing GENIE $genie_config..."
 
@@ -214,12 +221,12 @@ else
 	resfixfixswitch=0
 fi
 bash run_gevgen.sh \
-	-n $N_EVENTS \
+	-n $genie_n_events \
 	-f $genie_flux_file,$genie_flux_histo \
 	-p $NEUTRINO_PDG \
 	-t $genie_target \
 	-o $filename_raw \
-	--seed $genie_seed \
+	--seed $genie_generator_seed \
 	--tune $genie_config
 if [ $resfixfixswitch -eq 1 ];
 then
@@ -249,7 +256,7 @@ if [ $genie_config == "G18_10j_00_000" ] || [ $genie_config == "N18_10j_02_11a-r
 then
 	setup genie v3_04_00 -q e20:inclxx:prof
 fi
-root -q "${CONVENIENT_NUISANCE_DIR}/make_convenient_from_nuisance.C(\"${filename_nuisance}\", \"${filename_convenient}\", 1)"
+timed_stage convert bash ${CONVENIENT_NUISANCE_DIR}/make_convenient_from_nuisance.sh "${filename_nuisance}" "${filename_convenient}" 1
 
 # Move the output files to the folders matching the program that 
 # created them.
@@ -275,6 +282,6 @@ fi
 mkdir -p $nuisance_output_dir/$filepath
 mkdir -p $convenient_output_dir/$filepath
 # mv format is [file to move] [new directory and/or name]
-mv $filename_nuisance $nuisance_output_dir/$filepath/$filename_nuisance
-mv $filename_convenient $convenient_output_dir/$filepath/$filename_convenient
+timed_stage move mv $filename_nuisance $nuisance_output_dir/$filepath/$filename_nuisance
+timed_stage move mv $filename_convenient $convenient_output_dir/$filepath/$filename_convenient
 
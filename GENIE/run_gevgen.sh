@@ -41,6 +41,9 @@
 # She-bang!
 #!/bin/bash
 
+# For timed_stage
+source $CONVENIENT_DIR/documentation_generation_scripts/telemetry.sh
+
 # Set the target composition from the GENIE ND soup file. 
 # The file should already be in GENIE format, and 
 # should have a single line of text.
@@ -52,7 +55,7 @@ done < "$8"
 # Generate the GENIE events. See the GENIE user's manual for info on the 
 # gevgen command.
 echo "Running gevgen w/ tune ${14}"
-gevgen \
+timed_stage gevgen gevgen \
 	-n $2 \
 	-e $E_MIN,$E_MAX \
 	-f $4 \
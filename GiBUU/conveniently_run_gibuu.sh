@@ -37,6 +37,9 @@
 # She-bang!
 #!/bin/bash
 
+# For timed_stage
+source $CONVENIENT_DIR/documentation_generation_scripts/telemetry.sh
+
 # Read the inputs
 gibuu_config=$2
 gibuu_flux_file=$4
@@ -47,6 +50,10 @@ gibuu_seed=$8
 genie_target=${10}
 genie_rel_target=${genie_target/$CONVENIENT_TAR_DIR\//}
 
+# The seed of this shard, if any (see run_shard in run.sh). run_gibuu.sh 
+# works out the shard's share of the GiBUU runs itself.
+gibuu_generator_seed=${CONVENIENT_SHARD_SEED:-$gibuu_seed}
+
 # In $config, separate out params file from directory
 params=${gibuu_config#*/} # Params is everything after the /
 
@@ -77,7 +84,10 @@ source set_gibuu_variables.sh -f $gibuu_flux_file -h $gibuu_flux_histo
 # Tell us what tune we're on
 echo "Generating and processing GiBUU w/ params $params..."
 
-# Run GiBUU
+# Run GiBUU, converting each element's events into an unweighted 
+# Convenient file as soon as they have been generated. For a mixture, the 
+# same pass also writes each element's part of the composite file, in 
+# which its events are weighted by its fractional composition.
 # Format is
 	# -i input jobcard
 	# -o output file name -n number of events 
@@ -85,6 +95,12 @@ echo "Generating and processing GiBUU w/ params $params..."
 	# --flux_file gibuu .dat flux file 
 	# -t target composition file in GENIE format
 	# --seed MC seed
+	# --post command to run on each element's output
+post_target=""
+if [ $nova_switch -eq 1 ];
+then
+	post_target="-t $gibuu_target"
+fi
 bash run_gibuu.sh \
 	-i $gibuu_config \
 	-o $filename_raw \
@@ -93,90 +109,37 @@ bash run_gibuu.sh \
 	-c $GIBUU_CC_NC \
 	--flux_file $gibuu_dat_flux_file \
 	-t $gibuu_target \
-	--seed $gibuu_seed
+	--seed $gibuu_generator_seed \
+	--post "bash convert_gibuu_element.sh -i {} --flux_file $gibuu_dat_flux_file -p $NEUTRINO_PDG -c $GIBUU_CC_NC $post_target" || exit 1
 
-# Post-process the GiBUU output to output the Convenient file
-# We want a Convenient file for each GiBUU elemental file, plus 
-# an aggregate Convenient file in which the relative abundances 
-# of different nuclei are accounted for in the event weights, if 
-# the target is a mixture.
+# We have a Convenient file for each GiBUU elemental file. If the target 
+# is a mixture, we also want an aggregate Convenient file in which the 
+# relative abundances of different nuclei are accounted for in the event 
+# weights.
 if [ $nova_switch -eq 0 ];
 then
 	raw_gibuu_file=$(ls $filename_raw*)
 	filename_convenient=GiBUU:${raw_gibuu_file/raw/convenient_output}
 	filename_convenient=${filename_convenient/.dat/.root}
-	# Get the nucleus PDG from the filename
-	nucleus=${raw_gibuu_file/$filename_raw./}
-	nucleus=${nucleus/.dat/}
-	# Get the number of protons and nucleons from the nucleus PDG
-	protons=${nucleus:3:3}
-	protons=$((10#$protons))
-	nucleons=${nucleus:6:3}
-	nucleons=$((10#$nucleons))				
-	root -q "make_convenient_from_gibuu.C(\"${raw_gibuu_file}\", \"${gibuu_dat_flux_file}\", \"${NEUTRINO_PDG}\", \"${GIBUU_CC_NC}\", \"${protons}\", \"${nucleons}\", \"${filename_convenient}\", \"1\")"
 else
-	# First create a dictionary where the keys are the elements 
-	# in the mixture, and the values are the fractional 
-	# composition of the mixture
-	# Initialize the dictionary
 	filename_convenient=GiBUU:$filename.convenient_output.root
-	declare -A fractional_compositions
-	# Read in the target info from the GiBUU target .txt file
-	while read line;
-	do
-		gibuu_target_comp=$(echo $line)
-	done < "${gibuu_target}"
-	# Change the IFS to a comma, which we use for parsing the 
-	# target content input
-	IFS=","
-	# Loop over the elements and add each to the dictionary. 
-	read -a elements_fracs <<< "$gibuu_target_comp"
-	for element_frac in "${elements_fracs[@]}"
-	do
-		# Get the element
-		element=${element_frac%[*}
-		# Get the fractional composition
-		frac=${element_frac#*[}
-		frac=${frac%]*}
-		# Add to the dictionary
-		fractional_compositions[$element]=$frac
-	done
-	IFS=' '
-	# For each GiBUU file, create an unweighted Convenient 
-	# output and a Convenient output weighted by the fractional 
-	# composition. Also keep track of the weighted Convenient 
-	# outputs and unweighted Convenient outputs
+	# The parts of the composite file already have their weights, so 
+	# concatenating them only copies their compressed baskets. Also keep 
+	# track of the unweighted Convenient outputs.
 	unweighted_convenient_outputs=""
-	weighted_convenient_outputs=""
+	composite_parts=""
 	while IFS= read -r raw_gibuu_file
 	do
-		# Get the element that is the target for the file
-		element_from_filename=${raw_gibuu_file/$filename_raw./}
-		element_from_filename=${element_from_filename/.dat/}
-		# Get the weight for that element from the dictionary
-		weight=${fractional_compositions[$element_from_filename]}
-		# Get the number of protons and nucleons for the element
-		protons=${element_from_filename:3:3}
-		protons=$((10#$protons))
-		nucleons=${element_from_filename:6:3}
-		nucleons=$((10#$nucleons))
-		# Construct the output name for the unweighted 
-		# Convenient file, and run Convenient
 		convenient_elemental_output=${raw_gibuu_file/raw/convenient_output}
-		convenient_elemental_output=${convenient_elemental_output/dat/root}
+		convenient_elemental_output=${convenient_elemental_output/.dat/.root}
 		convenient_elemental_output=GiBUU:$convenient_elemental_output
-		root -q "make_convenient_from_gibuu.C(\"${raw_gibuu_file}\", \"${gibuu_dat_flux_file}\", \"${NEUTRINO_PDG}\", \"${GIBUU_CC_NC}\", \"${protons}\", \"${nucleons}\", \"${convenient_elemental_output}\", \"1\")"
 		unweighted_convenient_outputs+="$convenient_elemental_output"
 		unweighted_convenient_outputs+=$'\n'
-		# Construct the output name for the weighted Convenient 
-		# file, and run Convenient w/ the appropriate weight
-		convenient_weighted_output=${convenient_elemental_output/.$element_from_filename./.$element_from_filename.$weight.}
-
-		root -q "make_convenient_from_gibuu.C(\"${raw_gibuu_file}\", \"${gibuu_dat_flux_file}\", \"${NEUTRINO_PDG}\", \"${GIBUU_CC_NC}\", \"${protons}\", \"${nucleons}\", \"${convenient_weighted_output}\", \"${weight}\")"
-		weighted_convenient_outputs+="$convenient_weighted_output "
+		composite_parts+="${convenient_elemental_output%.root}.composite_part.root "
 	done <<< $(ls $filename_raw.*)
-	# Combine all the weighted files into one file
-	root -q "${CONVENIENT_NUISANCE_DIR}/make_convenient_from_convenient.C(\"${weighted_convenient_outputs}\", \"${filename_convenient}\")"
+	# Create the combined file, then remove the parts
+	timed_stage merge root -q "$CONVENIENT_NUISANCE_DIR/make_convenient_from_convenient.C(\"${composite_parts}\", \"${filename_convenient}\")"
+	rm -f $composite_parts
 fi
 
 # Move the output files to the folders matching the program that 
@@ -198,7 +161,7 @@ do
 	# Move the file
 	outdir=$OUTPUT_DIR/RawGiBUU/$filepath
 	mkdir -p $outdir
- 	mv $raw_gibuu_file $outdir/$raw_gibuu_file
+ 	timed_stage move mv $raw_gibuu_file $outdir/$raw_gibuu_file
 done <<< $(ls $filename_raw.*)
 
 # We want to save the files to either the NOvA specific 
@@ -209,7 +172,7 @@ then
 	# Take care of the Convenient file first
 	filepath=GiBUU/${GiBUU_VERSION}_${params%.job}/"$HC$flux"/"$FLAVOR""$GIBUU_CC_NC"_only
 	mkdir -p $convenient_output_dir/$filepath
-	mv $filename_convenient $convenient_output_dir/$filepath/$filename_convenient
+	timed_stage move mv $filename_convenient $convenient_output_dir/$filepath/$filename_convenient
 	# Move the unweighted Convenient files
 	while IFS= read -r unweighted_convenient_file
 	do
@@ -230,20 +193,14 @@ then
 		# Move the file
 		outdir=$CONVENIENT_OUTPUT_DIR/$filepath
 		mkdir -p $outdir
-		mv $unweighted_convenient_file $outdir/$unweighted_convenient_file
+		timed_stage move mv $unweighted_convenient_file $outdir/$unweighted_convenient_file
 		# Add to data list and write a .txt file
  		bash $CONVENIENT_DIR/documentation_generation_scripts/add_to_data_list.sh -g GiBUU -t ${GiBUU_VERSION}_${gibuu_config} -f $unweighted_convenient_file --flux $gibuu_flux --nova_switch 0
- 		bash $CONVENIENT_DIR/documentation_generation_scripts/create_output_txt_file.sh -l $outdir,$unweighted_convenient_file -n $N_EVENTS -h $HC -p $NEUTRINO_PDG -f $gibuu_flux_file,$gibuu_flux_histo -t $target -d $DATE -v $GiBUU_VERSION --seed $gibuu_seed	
+ 		bash $CONVENIENT_DIR/documentation_generation_scripts/create_output_txt_file.sh -l $outdir,$unweighted_convenient_file -n $N_EVENTS -h $HC -p $NEUTRINO_PDG -f $gibuu_flux_file,$gibuu_flux_histo -t $target -d $DATE -v $GiBUU_VERSION --seed $gibuu_seed --telemetry "$CONVENIENT_TELEMETRY_FILE"
 	done <<< $unweighted_convenient_outputs
 
 	# Reset the filepath
 	filepath=GiBUU/${GiBUU_VERSION}_${params%.job}/"$HC$flux"/"$FLAVOR""$GIBUU_CC_NC"_only
-
-	# Remove the weighted Convenient files
-	while IFS= read -r weighted_convenient_file
-	do
-		rm $weighted_convenient_file
-	done <<< $weighted_convenient_outputs
 else
 	# We just need to move the final convenient file. Documentation will be 
 	# added at the end
@@ -251,5 +208,5 @@ else
 	filepath=GiBUU/${GiBUU_VERSION}_${params%.job}/"$HC$flux"/"$FLAVOR""$GIBUU_CC_NC"_only/$target
 	# Move the file
 	mkdir -p $convenient_output_dir/$filepath
-	mv $filename_convenient $convenient_output_dir/$filepath/$filename_convenien
+	timed_stage move mv $filename_convenient $convenient_output_dir/$filepath/$filename_convenien
 fi
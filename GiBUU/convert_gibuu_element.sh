@@ -0,0 +1,99 @@
+# Author: Colin Weber (webe1077@umn.edu)
+# Date: 16 October 2026
+# Purpose: To turn the GiBUU output of one element into an unweighted 
+# Convenient file. run_gibuu.sh runs this on each element as soon as it 
+# has been generated (see its --post parameter), so that the elements are 
+# converted while the others are still being generated.
+
+# Command: bash convert_gibuu_element.sh
+#	[-i raw GiBUU file] [--flux_file gibuu .dat flux file]
+#	[-p neutrino pdg] [-c CC/NC flag]
+#	[-t target composition file]
+
+# Parameters
+#	-i
+#		The GiBUU output of one element, named as by run_gibuu.sh, i.e. 
+#		ending in .<nucleus PDG>.dat
+#	--flux_file
+#		The .dat flux file that was used to generate the GiBUU events
+#	-p
+#		The neutrino flavor used to generate the events, as a PDG code
+#	-c
+#		Whether the events generated were CC or NC
+#	-t
+#		Optional. For the elements of a composite target, the target 
+#		composition file in GENIE format. The element's part of the 
+#		composite file, weighted by its fractional composition, is then 
+#		written in the same pass as its unweighted file.
+
+# Outputs
+#	GiBUU:${raw_gibuu_file/raw/convenient_output}, with .dat replaced by 
+#	.root
+#		The unweighted Convenient file of the element
+#	GiBUU:${raw_gibuu_file/raw/convenient_output}, with .dat replaced by 
+#	.composite_part.root
+#		With -t, the element's part of the composite file
+
+# She-bang!
+#!/bin/bash
+
+# For timed_stage
+source $CONVENIENT_DIR/documentation_generation_scripts/telemetry.sh
+
+raw_gibuu_file=$2
+gibuu_dat_flux_file=$4
+neutrino_pdg=$6
+gibuu_cc_nc=$8
+gibuu_target=${10}
+
+filename_convenient=GiBUU:${raw_gibuu_file/raw/convenient_output}
+filename_convenient=${filename_convenient/.dat/.root}
+
+# Get the nucleus PDG from the filename
+nucleus=${raw_gibuu_file%.dat}
+nucleus=${nucleus##*.}
+# Get the number of protons and nucleons from the nucleus PDG
+protons=${nucleus:3:3}
+protons=$((10#$protons))
+nucleons=${nucleus:6:3}
+nucleons=$((10#$nucleons))
+
+# For a composite target, also write the element's part of the composite 
+# file, weighted by its fractional composition
+composite_part=""
+fraction=""
+if [ -n "$gibuu_target" ];
+then
+	while read line;
+	do
+		gibuu_target_comp=$(echo $line)
+	done < "${gibuu_target}"
+	IFS=","
+	read -a elements_fracs <<< "$gibuu_target_comp"
+	IFS=' '
+	for element_frac in "${elements_fracs[@]}"
+	do
+		if [ "${element_frac%[*}" == "$nucleus" ];
+		then
+			fraction=${element_frac#*[}
+			fraction=${fraction%]*}
+		fi
+	done
+	if [ -z "$fraction" ];
+	then
+		echo "$nucleus is not in the composition $gibuu_target!  Aborting."
+		exit 1
+	fi
+	composite_part=${filename_convenient%.root}.composite_part.root
+else
+	fraction=1
+fi
+
+timed_stage convert root -q "make_convenient_from_gibuu.C(\"${raw_gibuu_file}\", \"${gibuu_dat_flux_file}\", \"${neutrino_pdg}\", \"${gibuu_cc_nc}\", \"${protons}\", \"${nucleons}\", \"${filename_convenient}\", \"1\", \"${composite_part}\", \"${fraction}\")" || exit 1
+
+# ROOT exits with 0 even when the macro gives up, so check the outputs
+if [ ! -f "$filename_convenient" ] || { [ -n "$composite_part" ] && [ ! -f "$composite_part" ]; };
+then
+	echo "Could not convert $raw_gibuu_file!"
+	exit 1
+fi
@@ -3,7 +3,9 @@
 # Purpose: To generate events with GiBUU. This script primarily takes the 
 # inputs and uses them to automatically modify the appropriate lines in the 
 # GiBUU job card. The modified job card is then sent to GiBUU to generate 
-# events.
+# events. The elements of a mixed target are generated at the same time, 
+# up to CORES_PER_RUN at once, each from its own copy of the job card in 
+# its own directory.
 
 # Command: bash run_gibuu.sh
 #	[-i GiBUU job card]
@@ -11,7 +13,7 @@
 # 	[-p neutrino pdg] [-c CC/NC flag] 
 #	[--flux_file flux file] [--flux_histo flux_histo] 
 #	[-t target composition file in GENIE format]
-# 	[--seed MC seed]
+# 	[--seed MC seed] [--post post-processing command]
 
 # Parameters
 #	-i
@@ -22,7 +24,9 @@
 #		then one output is created per element in the mixture, and the 
 #		output filenames have the particle information appended.
 # 	-n
-#		The approximate number of events to generate
+#		The approximate number of events to generate. When run as a shard 
+#		(see run.sh), this is the number of events of the whole run, whose 
+#		GiBUU runs are split between the shards.
 #	-p
 #		The neutrino flavor to use in event generation, as a PDG code
 #	-c
@@ -36,6 +40,11 @@
 #		Examples are in the directory CONVENIENT/targets.
 #	--seed
 #		The MC seed to use
+#	--post
+#		Optional. A command to run on the output of each element as soon as 
+#		it has been generated, while the other elements are still being 
+#		generated. Any {} in it is replaced by the output file name. If it 
+#		fails on any element, the script exits non-zero.
 
 # Outputs
 #	$gibuu_elemental_outputs
@@ -45,6 +54,9 @@
 # She-bang!
 #!/bin/bash
 
+# For timed_stage
+source $CONVENIENT_DIR/documentation_generation_scripts/telemetry.sh
+
 # Each of the parameters except the card file and output file name is 
 # set by going into the card file and modifying the appropriate line
 
@@ -143,79 +155,170 @@ done < "${14}"
 # Change the Internal Field Separator to a comma, which we use for 
 # parsing the target content input
 IFS=','
-
-# Loop over the targets, running GiBUU for each
 read -a parts <<< "$gibuu_target_comp"
-for part in "${parts[@]}" # For each part(icle)
+
+# Return IFS to its original value
+IFS=' '
+
+# Read in the rest of the inputs, since the positional parameters are 
+# not visible inside the function below
+gibuu_card=$2
+gibuu_output=$4
+gibuu_n_events=$6
+post_command=${18}
+
+# GiBUU generates events in whole runs of about A * numEnsembles events, so 
+# a shard gets its share of the runs of the whole run rather than of its 
+# events
+if [ -n "$CONVENIENT_SHARD" ];
+then
+	shard=$CONVENIENT_SHARD
+	n_shards=${N_SHARDS:-1}
+else
+	shard=0
+	n_shards=1
+fi
+
+# The number of runs of the whole run on an element with the given number 
+# of nucleons, using n_events ~ target A * numEnsembles * 
+# num_runs_SameEnergy
+# Format is whole_runs nucleons
+whole_runs() {
+	echo $(( $gibuu_n_events / $1 / $numEnsembles ))
+}
+
+# Every shard needs at least one run on every element
+for part in "${parts[@]}"
 do
-	# Extract the number of protons from the PDG code
-	protons=${part:3:3}
-	# Strip leading 0's
-	protons=$((10#$protons))	
-	# Alter the line in the card file
-	sed -i "/^[ \t]*Z=.*/s/[0-9]\+/${protons}/" $2
-
-	# Extract the number of nucleons from the PDG code
-	nucleons=${part:6:3} 
-	# Strip leading 0's
-	nucleons=$((10#$nucleons))
-	# Alter the line in the card file
-	sed -i "/^[ \t]*A=.*/s/[0-9]\+/${nucleons}/" $2
-
-	# The parameter densitySwitch_Static determines the nuclear density 
-	# model to use. By default, it is set to 2, corresponding to the NPA 554 
-	# model. However, this model has only been worked out for some nuclei, 
-	# so GiBUU suggests that the switch be set to 1 (Woods-Saxon potential) 
-	# for all other nuclei.
-	if [[   ($protons -eq 6     && $nucleons -eq 12) || 
-    	    ($protons -eq 1     && $nucleons -eq 1 ) || 
-        	($protons -eq 8     && $nucleons -eq 18) || 
-        	($protons -eq 8     && $nucleons -eq 16) || 
-        	($protons -eq 16    && $nucleons -eq 32) || 
-        	($protons -eq 20    && $nucleons -eq 40) ]];
+	nucleons=$((10#${part:6:3}))
+	if [ $(whole_runs $nucleons) -lt $n_shards ];
 	then
-    	densitySwitch_Static=2
-	else
-   		densitySwitch_Static=1
+		echo "Error: $gibuu_n_events events make only $(whole_runs $nucleons) GiBUU run(s) on ${part%[*}, which can't be split into $n_shards shard(s). Use more events or fewer shards."
+		exit 1
 	fi
-	sed -i "/^[ \t]*densitySwitch_Static=.*/s/[0-9]\+/${densitySwitch_Static}/" $2
-
-	# Set the number of events using the formula n_events ~ target A * 
-	# numEnsembles * num_runs_SameEnergy. The last constant is the one to 
-	# modify to get the desired n_events, since we have already set target A 
-	# and numEnsembles.
-	gibuu_n_events=$6
-	num_runs_SameEnergy=`echo "$gibuu_n_events / $nucleons / $numEnsembles" | bc`
-	sed -i "/^[ \t]*num_runs_SameEnergy=.*/s/[0-9]\+/${num_runs_SameEnergy}/" $2
-
-	### Generate GiBUU events by inputting the job card that has just been 
-	### modified and specifying the name of the output file.
-	gibuu_elemental_outputs=$4.${part%[*}.dat
+done
+
+# The elements are generated at the same time, up to CORES_PER_RUN at 
+# once, and each one's threads get an equal share of those cores
+max_element_jobs=${CORES_PER_RUN:-1}
+if [ $max_element_jobs -gt ${#parts[@]} ];
+then
+	max_element_jobs=${#parts[@]}
+fi
+element_threads=$(( ${CORES_PER_RUN:-1} / $max_element_jobs ))
+
+# Generate the events of one element, then post-process them right away. 
+# GiBUU writes many files to the directory it runs in, so each element 
+# gets its own directory, holding its own copy of the job card. The 
+# directory is deleted once the events are out of it.
+# Format is run_element part
+run_element() {
+	part=$1
+	element=${part%[*}
+	gibuu_elemental_outputs=$gibuu_output.$element.dat
 	if [ ! -f $gibuu_elemental_outputs ];
 	then
-		$GiBUU < $2 
-		mv FinalEvents.dat $gibuu_elemental_outputs
-		# GiBUU gives us a crazy number of output files, so we need to delete 
-		# as we go.
-		rm DensTab_target.dat
-		rm diff*
-		rm Event*
-		rm GiBUU_*
-		rm main.run
-		rm mass*
-		rm Multiplicity*
-		rm neutrino*
-		rm NucleonVacuumMass.dat
-		rm OutChannels*
-		rm PYR.RG
-		rm ReAdjust*
-		rm reconstruction*
-		rm sigma*
-	else
-		continue
-	fi	
-done
+		element_dir=element_$element
+		rm -rf $element_dir
+		mkdir -p $element_dir
+		element_card=$element_dir/${gibuu_card##*/}
+		cp $gibuu_card $element_card
 
-# Return IFS to its original value
-IFS=' '
+		# Extract the number of protons from the PDG code
+		protons=${part:3:3}
+		# Strip leading 0's
+		protons=$((10#$protons))	
+		# Alter the line in the card file
+		sed -i "/^[ \t]*Z=.*/s/[0-9]\+/${protons}/" $element_card
 
+		# Extract the number of nucleons from the PDG code
+		nucleons=${part:6:3} 
+		# Strip leading 0's
+		nucleons=$((10#$nucleons))
+		# Alter the line in the card file
+		sed -i "/^[ \t]*A=.*/s/[0-9]\+/${nucleons}/" $element_card
+
+		# The parameter densitySwitch_Static determines the nuclear density 
+		# model to use. By default, it is set to 2, corresponding to the NPA 
+		# 554 model. However, this model has only been worked out for some 
+		# nuclei, so GiBUU suggests that the switch be set to 1 
+		# (Woods-Saxon potential) for all other nuclei.
+		if [[   ($protons -eq 6     && $nucleons -eq 12) || 
+    		    ($protons -eq 1     && $nucleons -eq 1 ) || 
+        		($protons -eq 8     && $nucleons -eq 18) || 
+        		($protons -eq 8     && $nucleons -eq 16) || 
+        		($protons -eq 16    && $nucleons -eq 32) || 
+        		($protons -eq 20    && $nucleons -eq 40) ]];
+		then
+    		densitySwitch_Static=2
+		else
+   			densitySwitch_Static=1
+		fi
+		sed -i "/^[ \t]*densitySwitch_Static=.*/s/[0-9]\+/${densitySwitch_Static}/" $element_card
+
+		# Set the number of events using the formula n_events ~ target A * 
+		# numEnsembles * num_runs_SameEnergy. The last constant is the one 
+		# to modify to get the desired n_events, since we have already set 
+		# target A and numEnsembles. The runs are shared out between the 
+		# shards, the first ones taking one more if they don't divide evenly.
+		total_runs=$(whole_runs $nucleons)
+		num_runs_SameEnergy=$(( $total_runs / $n_shards ))
+		if [ $shard -lt $(( $total_runs % $n_shards )) ];
+		then
+			num_runs_SameEnergy=$(( $num_runs_SameEnergy + 1 ))
+		fi
+		sed -i "/^[ \t]*num_runs_SameEnergy=.*/s/[0-9]\+/${num_runs_SameEnergy}/" $element_card
+
+		### Generate GiBUU events by inputting the job card that has just 
+		### been modified, from within the element's directory.
+		echo "Generating GiBUU events on $element..."
+		(
+			cd $element_dir
+			timed_stage GiBUU env OMP_NUM_THREADS=$element_threads $GiBUU \
+				< ${gibuu_card##*/}
+		)
+		timed_stage move mv $element_dir/FinalEvents.dat \
+			$gibuu_elemental_outputs || return 1
+		# GiBUU gives us a crazy number of output files, which all stay in 
+		# the element's directory
+		rm -rf $element_dir
+	fi
+
+	# Post-process the element's events while the other elements are 
+	# still being generated
+	if [ -n "$post_command" ];
+	then
+		eval "${post_command//\{\}/$gibuu_elemental_outputs}" || return 1
+	fi
+}
+
+# Start each element as soon as fewer than max_element_jobs are going
+for part in "${parts[@]}" # For each part(icle)
+do
+	# Poll, rather than wait -n (see run.sh)
+	while [ $(jobs -rp | wc -l) -ge $max_element_jobs ];
+	do
+		sleep 1
+	done
+	# The elements run in the background, so a failure is recorded in a 
+	# marker file for the check below
+	( run_element $part || touch $gibuu_output.${part%[*}.failed ) &
+done
+wait
+
+# Check that every element was generated
+status=0
+for part in "${parts[@]}"
+do
+	if [ ! -f $gibuu_output.${part%[*}.dat ];
+	then
+		echo "GiBUU did not generate any events on ${part%[*}!"
+		status=1
+	elif [ -f $gibuu_output.${part%[*}.failed ];
+	then
+		echo "The events on ${part%[*} could not be post-processed!"
+		status=1
+	fi
+	rm -f $gibuu_output.${part%[*}.failed
+done
+exit $status
@@ -70,12 +70,9 @@ export numEnsembles=4000
 gibuu_original_flux_file=${2/$CONVENIENT_DIR\//}
 gibuu_original_flux_histo=$4
 export gibuu_dat_flux_file="$CONVENIENT_DIR/GiBUU/beam_energies/"${gibuu_original_flux_file//[\/]/_}"."$gibuu_original_flux_histo".dat"
-if [ ! -f "$gibuu_dat_flux_file" ];
-then
-	# Translate the original flux file to a .dat file in the appropriate 
-	# format
-	root -q "make_beam_energy_dat.C(\"${2}\", \"$gibuu_original_flux_histo\", \"$gibuu_dat_flux_file\")"
-fi
+# Make sure it exists and is up to date. The flux exporter writes the fluxes 
+# of all the generators at once, and caches them.
+bash $CONVENIENT_DIR/flux/export_flux.sh -f "${2}" -h "$gibuu_original_flux_histo"
 
 # Let us know we're done
 echo "GiBUU variables set."
@@ -39,6 +39,9 @@
 # She-bang!
 #!/bin/bash
 
+# For timed_stage
+source $CONVENIENT_DIR/documentation_generation_scripts/telemetry.sh
+
 # Read the inputs
 neut_config=$2
 neut_flux_file=$4
@@ -49,6 +52,10 @@ neut_seed=$8
 genie_target=${10}
 genie_rel_target=${genie_target/$CONVENIENT_TAR_DIR\//}
 
+# The events and seed of this shard, if any (see run_shard in run.sh)
+neut_n_events=${CONVENIENT_SHARD_EVENTS:-$N_EVENTS}
+neut_generator_seed=${CONVENIENT_SHARD_SEED:-$neut_seed}
+
 # In $config, separate out params file from directory
 params=${neut_config#*/} # Params is everything after the /
 
@@ -73,39 +80,36 @@ filename_raw=$filename.raw.root
 filename_nuisance=NEUT:$filename.NUISANCE.root
 
 # Set the run variables. This includes the NEUT output filename
-source set_neut_variables.sh -s $neut_seed
+source set_neut_variables.sh -s $neut_generator_seed
 
 # Tell us what tune we're on
 echo "Generating and processing NEUT w/ params $params..."
 
-# Run NEUT
+# Run NEUT, running NUISANCE on each element's events as soon as they 
+# have been generated
 # Format is
 	# -i input parameters file
 	# -o output file name -n number of events 
 	# -p neutrino pdg --flux_file flux file 
 	# --flux_histo flux histo
 	# -t target composition file in NEUT format
-bash run_neut.sh \
-	-i $neut_config \
-	-o $filename_raw \
-	-n $N_EVENTS \
-	-p $NEUTRINO_PDG \
-	--flux_file $neut_flux_file \
-	--flux_histo $neut_flux_histo \
-	-t $neut_target
-
-# Run NUISANCE on the output from above.
-# Format is (for a beam with only one neutrino flavor)
+	# --post command to run on each element's output
+# The NUISANCE command format is (for a beam with only one neutrino flavor)
 	# -i input file name
 	# -f flux file
 	# -h flux histo
 # Ouptut names are handled within run_neut_nuisance 
 source $CONVENIENT_NUISANCE_DIR/set_nuisance_variables.sh
 
-bash $CONVENIENT_NUISANCE_DIR/run_neut_nuisance.sh \
-	-i $filename_raw \
-	-f $neut_flux_file \
-	-h $neut_flux_histo
+bash run_neut.sh \
+	-i $neut_config \
+	-o $filename_raw \
+	-n $neut_n_events \
+	-p $NEUTRINO_PDG \
+	--flux_file $neut_flux_file \
+	--flux_histo $neut_flux_histo \
+	-t $neut_target \
+	--post "bash $CONVENIENT_NUISANCE_DIR/run_neut_nuisance.sh -i {} -f $neut_flux_file -h $neut_flux_histo"
 
 # Post-process the NUISANCE output to output the Convenient file
 # We want a Convenient file for each NUISANCE file, plus an 
@@ -117,7 +121,7 @@ then
 	raw_neut_file=$(ls $filename_raw*)
 	nuisance_neut_file=NEUT:${raw_neut_file/raw/NUISANCE}
 	filename_convenient=NEUT:${raw_neut_file/raw/convenient_output}
-	root -q "${CONVENIENT_NUISANCE_DIR}/make_convenient_from_nuisance.C(\"${nuisance_neut_file}\", \"${filename_convenient}\", 1)"
+	timed_stage convert bash ${CONVENIENT_NUISANCE_DIR}/make_convenient_from_nuisance.sh "${nuisance_neut_file}" "${filename_convenient}" 1
 else
 	# First create a dictionary where the keys are the elements 
 	# in the mixture, and the values are the fractional 
@@ -147,11 +151,13 @@ else
 	done
 	IFS=' '
 	# For each NUISANCE file, create an unweighted Convenient 
-	# output and a Convenient output weighted by the fractional 
-	# composition. Also keep track of the weighted Convenient 
-	# outputs and unweighted Convenient outputs
+	# output, and create one Convenient output for the whole 
+	# mixture in which each element is weighted by its fractional 
+	# composition. All of these are made in a single call, which 
+	# reads each NUISANCE file once. Also keep track of the 
+	# unweighted Convenient outputs.
 	unweighted_convenient_outputs=""
-	weighted_convenient_outputs=""
+	composite_args=()
 	while IFS= read -r nuisance_neut_file
 	do
 		# Get the element that is the target for the file
@@ -160,19 +166,14 @@ else
 		# Get the weight for that element from the dictionary
 		weight=${fractional_compositions[$element_from_filename]}
 		# Construct the output name for the unweighted 
-		# Convenient file, and run Convenient
+		# Convenient file
 		convenient_elemental_output=${nuisance_neut_file/NUISANCE/convenient_output}
-		root -q "${CONVENIENT_NUISANCE_DIR}/make_convenient_from_nuisance.C(\"${nuisance_neut_file}\", \"${convenient_elemental_output}\", 1)"
 		unweighted_convenient_outputs+="$convenient_elemental_output"
 		unweighted_convenient_outputs+=$'\n'
-		# Construct the output name for the weighted Convenient 
-		# file, and run Convenient w/ the appropriate weight
-		convenient_weighted_output=${convenient_elemental_output/.$element_from_filename./.$element_from_filename.$weight.}
-		weighted_convenient_outputs+="$convenient_weighted_output "
-		root -q "${CONVENIENT_NUISANCE_DIR}/make_convenient_from_nuisance.C(\"${nuisance_neut_file}\", \"${convenient_weighted_output}\", ${weight})"
+		composite_args+=("$nuisance_neut_file" "$convenient_elemental_output" "$weight")
 	done <<< $(ls $filename_nuisance.*)
-	# Combine all the weighted files into one file
-	root -q "${CONVENIENT_NUISANCE_DIR}/make_convenient_from_convenient.C(\"${weighted_convenient_outputs}\", \"${filename_convenient}\")"
+	# Create the elemental files and the combined file
+	timed_stage convert bash ${CONVENIENT_NUISANCE_DIR}/make_convenient_from_nuisance.sh --composite "${filename_convenient}" "${composite_args[@]}"
 fi
 
 # Move the output files to the folders matching the program that 
@@ -181,7 +182,7 @@ echo "NEUT run complete, moving files..."
 
 # Delete the extra NEUT files to save space.
 rm $filename_raw.* # Takes care of the raw NEUT outputs
-rm "$neut_flux_histo"_o.root # Takes care of this NEUT output
+rm -f "$neut_flux_histo"_o.root # Takes care of this NEUT output
 rm random.txt	# Takes care of the random number .txt file
 
 # We want to save the files to either the NOvA specific 
@@ -192,7 +193,7 @@ then
 	# Take care of the Convenient file first
 	filepath=NEUT/${NEUT_VERSION}_${params%.card}/"$HC$flux"/"$FLAVOR"_only
 	mkdir -p $convenient_output_dir/$filepath
-	mv $filename_convenient $convenient_output_dir/$filepath/$filename_convenient
+	timed_stage move mv $filename_convenient $convenient_output_dir/$filepath/$filename_convenient
 
 	# Move the NUISANCE files
 	while IFS= read -r nuisance_neut_file
@@ -209,7 +210,7 @@ then
 		# Move the file
 		outdir=$CONVENIENT_NUISANCE_OUTPUT_DIR/$filepath
 		mkdir -p $outdir
-		mv $nuisance_neut_file $outdir/$nuisance_neut_file
+		timed_stage move mv $nuisance_neut_file $outdir/$nuisance_neut_file
 	done <<< $(ls $filename_nuisance.*)
 
 	# Move the unweighted Convenient files
@@ -231,21 +232,15 @@ then
 		# Move the file
 		outdir=$CONVENIENT_OUTPUT_DIR/$filepath
 		mkdir -p $outdir
-		mv $unweighted_convenient_file $outdir/$unweighted_convenient_file
+		timed_stage move mv $unweighted_convenient_file $outdir/$unweighted_convenient_file
 		# Add to data list and write a .txt file
 		bash $CONVENIENT_DIR/documentation_generation_scripts/add_to_data_list.sh -g NEUT -t ${NEUT_VERSION}_$neut_config -f $unweighted_convenient_file --flux $neut_flux --nova_switch 0
-		bash $CONVENIENT_DIR/documentation_generation_scripts/create_output_txt_file.sh -l $outdir,$unweighted_convenient_file -n $N_EVENTS -h $HC -p $NEUTRINO_PDG -f $neut_flux_file,$neut_flux_histo -t $target -d $DATE -v $NEUT_VERSION --seed $neut_seed
+		bash $CONVENIENT_DIR/documentation_generation_scripts/create_output_txt_file.sh -l $outdir,$unweighted_convenient_file -n $N_EVENTS -h $HC -p $NEUTRINO_PDG -f $neut_flux_file,$neut_flux_histo -t $target -d $DATE -v $NEUT_VERSION --seed $neut_seed --telemetry "$CONVENIENT_TELEMETRY_FILE"
 
 	done <<< $unweighted_convenient_outputs
 
 	# Reset the filepath
 	filepath=NEUT/${NEUT_VERSION}_${params%.card}/"$HC$flux"/"$FLAVOR"_only
-
-	# Remove the weighted Convenient files
-	while IFS= read -r weighted_convenient_file
-	do
-		rm $weighted_convenient_file
-	done <<< $weighted_convenient_outputs
 else
 	filepath=NEUT/${NEUT_VERSION}_${params%.card}/"$HC$flux"/"$FLAVOR"_only/$target
 	# mkdir format is straightforward. 
@@ -253,6 +248,6 @@ else
 	mkdir -p $nuisance_output_dir/$filepath
 	mkdir -p $convenient_output_dir/$filepath
 	# mv format is [file to move] [new directory and/or name]
-	mv $nuisance_neut_file $nuisance_output_dir/$filepath/$nuisance_neut_file
-	mv $filename_convenient $convenient_output_dir/$filepath/$filename_convenient
+	timed_stage move mv $nuisance_neut_file $nuisance_output_dir/$filepath/$nuisance_neut_file
+	timed_stage move mv $filename_convenient $convenient_output_dir/$filepath/$filename_convenient
 fi
@@ -1,12 +1,15 @@
 # Author: Colin M Weber (webe1077@umn.edu)
 # Date: 8 April 2024
-# Purpose: To generate events with NEUT
+# Purpose: To generate events with NEUT. The elements of a mixed target 
+# are generated at the same time, up to CORES_PER_RUN at once, each from 
+# its own copy of the card file in its own directory.
 
 # Command: bash run_neut.sh
 #	[-i NEUT card file]
 #	[-o output file name] [-n number of events]
 # 	[-p neutrino pdg] [--flux_file flux file]
 # 	[--flux_histo flux_histo] [-t target composition file in GENIE format]
+# 	[--post post-processing command]
 
 # Parameters
 #	-i
@@ -27,6 +30,11 @@
 #	-t
 #		A .txt file containing the target information in GENIE format.
 #		Examples are in the directory CONVENIENT/targets.
+#	--post
+#		Optional. A command to run on the output of each element as soon as 
+#		it has been generated, while the other elements are still being 
+#		generated. Any {} in it is replaced by the output file name. If it 
+#		fails on any element, the script exits non-zero.
 
 # Outputs
 #	$neut_elemental_outputs
@@ -36,6 +44,9 @@
 # She-bang!
 #!/bin/bash
 
+# For timed_stage
+source $CONVENIENT_DIR/documentation_generation_scripts/telemetry.sh
+
 # Each of the parameters except the card file and output file name is 
 # set by going into the card file and modifying the appropriate line
 
@@ -73,20 +84,15 @@
 	neut_root_beam_filepath="$CONVENIENT_DIR/NEUT/beam_energies/"$neut_original_flux_filename"."$neut_original_flux_histo".root"
 	neut_txt_beam_filepath="$CONVENIENT_DIR/NEUT/beam_energies/"$neut_original_flux_filename"."$neut_original_flux_histo".txt"
 	
-	# Check to see if the NEUT flux file has been created yet. If it has not 
-	# been created:
-	if [ ! -f "$neut_root_beam_filepath" ];
-	then
-		# Translate the original flux file to a .txt file, zeroing the 
-		# relevant bins in the process
-		root -q "make_beam_energy_txt.C(\"${10}\", \"$neut_original_flux_histo\", \"$neut_txt_beam_filepath\")"
-
-		# Translate the .txt file to a .root file
-		root -q "make_flux_hist_root.C(\"$neut_txt_beam_filepath\", \"$neut_root_beam_filepath\", \"$neut_original_flux_histo\")"
-	fi
+	# Make sure the NEUT flux file exists and is up to date. The flux 
+	# exporter writes the fluxes of all the generators at once, zeroing the 
+	# bins below 100 MeV for NEUT, and caches them.
+	bash $CONVENIENT_DIR/flux/export_flux.sh -f "${10}" -h "$neut_original_flux_histo" || exit 1
 
-	# Assign the variable
-	neut_flux_file=${neut_root_beam_filepath/"$PWD/"/}
+	# Assign the variable. The path is kept relative (beam_energies is 
+	# linked into the working directory of each run), since NEUT only 
+	# reads a limited number of characters of it.
+	neut_flux_file=beam_energies/${neut_root_beam_filepath##*/}
 
 	# Modify the line holding the flux file variable by replacing the 
 	# current value with the new one
@@ -120,48 +126,121 @@ done < "${14}"
 # Change the Internal Field Separator to a comma, which we use for 
 # parsing the target content input
 IFS=','
-
-# Loop over the targets, running NEUT for each
 read -a parts <<< "$neut_target_comp"
-for part in "${parts[@]}" # For each part(icle)
-do
-	# Extract the number of protons from the PDG code
-	protons=${part:3:3}
-	# Strip leading 0's
-	protons=$((10#$protons))	
-	# Alter the line in the card file
-	sed -i 's/^NEUT-NUMBNDP .*/NEUT-NUMBNDP '"${protons}"'/' $2
-
-	# Extract the number of nucleons from the PDG code
-	nucleons=${part:6:3} 
-	# Strip leading 0's
-	nucleons=$((10#$nucleons))
-	# Alter the line in the card file
-	sed -i 's/^NEUT-NUMATOM .*/NEUT-NUMATOM '"${nucleons}"'/' $2
-
-	# Calculate the number of neutrons
-	neutrons=$(($nucleons - $protons))	
-	# Alter the line in the card file
-	sed -i 's/^NEUT-NUMBNDN .*/NEUT-NUMBNDN '"${neutrons}"'/' $2
-
-	# Calculate the number of free protons. This is given by the last digit 
-	# in the 10 digit NEUT-modified PDG string.
-	free_protons=${part:9:1}
-	# Alter the line in the card file
-	sed -i 's/^NEUT-NUMFREP .*/NEUT-NUMFREP '"${free_protons}"'/' $2
-
-	### Generate NEUT events by inputting the card file that has just been 
-	### modified and specifying the name of the output file.
+
+# Return IFS to its original value
+IFS=' '
+
+# Read in the rest of the inputs, since the positional parameters are 
+# not visible inside the function below
+neut_card=$2
+neut_output=$4
+post_command=${16}
+
+# The elements are generated at the same time, up to CORES_PER_RUN at 
+# once, and each one's threads get an equal share of those cores
+max_element_jobs=${CORES_PER_RUN:-1}
+if [ $max_element_jobs -gt ${#parts[@]} ];
+then
+	max_element_jobs=${#parts[@]}
+fi
+element_threads=$(( ${CORES_PER_RUN:-1} / $max_element_jobs ))
+
+# Generate the events of one element, then post-process them right away. 
+# NEUT writes files to the directory it runs in, so each element gets its 
+# own directory, holding its own copies of the card file and random number 
+# file and a link to the flux files. The directory is deleted once the 
+# events are out of it.
+# Format is run_element part
+run_element() {
+	part=$1
+	element=${part%[*}
+	neut_elemental_outputs=$neut_output.$element.root
 	### Only generate events if they haven't yet been generated
-	neut_elemental_outputs=$4.${part%[*}.root
 	if [ ! -f $neut_elemental_outputs ];
 	then
-		neutroot2 $2 $neut_elemental_outputs
-	else
-		continue
+		element_dir=element_$element
+		rm -rf $element_dir
+		mkdir -p $element_dir
+		ln -s $PWD/beam_energies $element_dir/beam_energies
+		cp $RANFILE $element_dir/$RANFILE
+		element_card=$element_dir/${neut_card##*/}
+		cp $neut_card $element_card
+
+		# Extract the number of protons from the PDG code
+		protons=${part:3:3}
+		# Strip leading 0's
+		protons=$((10#$protons))	
+		# Alter the line in the card file
+		sed -i 's/^NEUT-NUMBNDP .*/NEUT-NUMBNDP '"${protons}"'/' $element_card
+
+		# Extract the number of nucleons from the PDG code
+		nucleons=${part:6:3} 
+		# Strip leading 0's
+		nucleons=$((10#$nucleons))
+		# Alter the line in the card file
+		sed -i 's/^NEUT-NUMATOM .*/NEUT-NUMATOM '"${nucleons}"'/' $element_card
+
+		# Calculate the number of neutrons
+		neutrons=$(($nucleons - $protons))	
+		# Alter the line in the card file
+		sed -i 's/^NEUT-NUMBNDN .*/NEUT-NUMBNDN '"${neutrons}"'/' $element_card
+
+		# Calculate the number of free protons. This is given by the last 
+		# digit in the 10 digit NEUT-modified PDG string.
+		free_protons=${part:9:1}
+		# Alter the line in the card file
+		sed -i 's/^NEUT-NUMFREP .*/NEUT-NUMFREP '"${free_protons}"'/' $element_card
+
+		### Generate NEUT events by inputting the card file that has just 
+		### been modified and specifying the name of the output file, from 
+		### within the element's directory.
+		echo "Generating NEUT events on $element..."
+		(
+			cd $element_dir
+			timed_stage neutroot2 env OMP_NUM_THREADS=$element_threads \
+				neutroot2 ${neut_card##*/} ${neut_elemental_outputs##*/}
+		)
+		timed_stage move mv $element_dir/${neut_elemental_outputs##*/} \
+			$neut_elemental_outputs || return 1
+		rm -rf $element_dir
 	fi
-done
 
-# Return IFS to its original value
-IFS=' '
+	# Post-process the element's events while the other elements are 
+	# still being generated
+	if [ -n "$post_command" ];
+	then
+		eval "${post_command//\{\}/$neut_elemental_outputs}" || return 1
+	fi
+}
+
+# Start each element as soon as fewer than max_element_jobs are going
+for part in "${parts[@]}" # For each part(icle)
+do
+	# Poll, rather than wait -n (see run.sh)
+	while [ $(jobs -rp | wc -l) -ge $max_element_jobs ];
+	do
+		sleep 1
+	done
+	# The elements run in the background, so a failure is recorded in a 
+	# marker file for the check below
+	( run_element $part || touch $neut_output.${part%[*}.failed ) &
+done
+wait
 
+# Check that every element was generated
+status=0
+for part in "${parts[@]}"
+do
+	if [ ! -f $neut_output.${part%[*}.root ];
+	then
+		echo "NEUT did not generate any events on ${part%[*}!"
+		status=1
+	elif [ -f $neut_output.${part%[*}.failed ];
+	then
+		echo "The events on ${part%[*} could not be post-processed!"
+		status=1
+	fi
+	rm -f $neut_output.${part%[*}.failed
+done
+exit $status
@@ -0,0 +1,91 @@
+// Author: Colin Weber (webe1077@umn.edu)
+// Date: 16 October 2026
+// Purpose: A compiled version of make_convenient_from_nuisance.C. Running
+// the macro through the ROOT interpreter is a measurable part of every
+// run, so the run scripts call this executable instead. The conversion
+// itself is the one in make_convenient_from_nuisance.C, so both give the
+// same output.
+
+// Command: convenient_from_nuisance input outname \
+//	[element_abundance_weight] [n_threads]
+// or, for a composite target (see make_convenient_composite_from_nuisance.C),
+//	convenient_from_nuisance --composite composite_outname \
+//	input_1 outname_1 weight_1 [input_2 outname_2 weight_2 ...]
+
+// Parameters
+// 	input : str
+// 		The NUISANCE file to be turned into a CONVENIENT file, relative to
+// 		the current directory
+// 	outname : str
+// 		The name of the output file. Must end in ".root"
+// 	element_abundance_weight : double, defaults to 1
+// 		A weight that contributes to the "event_weight". See
+// 		make_convenient_from_nuisance.C.
+// 	n_threads : int, defaults to 0
+// 		The number of threads ROOT may use to compress and decompress
+// 		baskets. 0 lets ROOT decide based on the available cores.
+// 	composite_outname : str
+// 		The name of the CONVENIENT file for the whole composite target
+// 	input_i, outname_i, weight_i
+// 		The NUISANCE file, unweighted CONVENIENT file, and fractional
+// 		composition of each element of the composite target
+
+// Outputs
+// 	outname : TFile
+// 		The output CONVENIENT file created from the input NUISANCE file
+// 	composite_outname, outname_i : TFile
+// 		For a composite target, the CONVENIENT file for the whole target
+// 		and the unweighted CONVENIENT file of each element
+
+// Includes
+// ROOT includes
+#include "TROOT.h" // For enabling implicit multithreading
+
+// CONVENIENT includes
+// For the conversions. This also includes make_convenient_from_nuisance.C
+#include "make_convenient_composite_from_nuisance.C"
+
+// C++ includes
+#include <cstdlib> // For parsing the arguments
+#include <iostream> // For printing the usage
+#include <string> // For parsing the arguments
+
+int main(int argc, char** argv) {
+	// Composite targets
+	if(argc > 1 && std::string(argv[1]) == "--composite") {
+		if(argc < 6 || (argc - 3) % 3 != 0) {
+			std::cerr << "Usage: " << argv[0] << " --composite " << \
+				"composite_outname input_1 outname_1 weight_1 " << \
+				"[input_2 outname_2 weight_2 ...]" << std::endl;
+			return 1;
+		}
+		TString inputs, outnames, weights;
+		for(int i = 3; i < argc; i += 3) {
+			inputs += TString(argv[i]) + " ";
+			outnames += TString(argv[i+1]) + " ";
+			weights += TString(argv[i+2]) + " ";
+		}
+		ROOT::EnableImplicitMT();
+		make_convenient_composite_from_nuisance(inputs, outnames, weights, \
+			argv[2]);
+		return 0;
+	}
+
+	// Single targets
+	if(argc < 3 || argc > 5) {
+		std::cerr << "Usage: " << argv[0] << " input outname " << \
+			"[element_abundance_weight] [n_threads]" << std::endl;
+		return 1;
+	}
+	TString input = argv[1];
+	TString outname = argv[2];
+	double element_abundance_weight = (argc > 3) ? atof(argv[3]) : 1;
+	int n_threads = (argc > 4) ? atoi(argv[4]) : 0;
+
+	// Let ROOT compress the output baskets (and decompress the input ones)
+	// in parallel while the event loop runs.
+	ROOT::EnableImplicitMT(n_threads);
+
+	make_convenient_from_nuisance(input, outname, element_abundance_weight);
+	return 0;
+}
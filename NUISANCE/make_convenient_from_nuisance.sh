@@ -0,0 +1,67 @@
+# Author: Colin Weber (webe1077@umn.edu)
+# Date: 16 October 2026
+# Purpose: To turn a NUISANCE file into a CONVENIENT file. Uses the
+# compiled converter if it has been built, and falls back to running
+# make_convenient_from_nuisance.C through ROOT otherwise.
+
+# Command: bash make_convenient_from_nuisance.sh input outname \
+#	element_abundance_weight
+# or, for a composite target,
+#	bash make_convenient_from_nuisance.sh --composite composite_outname \
+#	input_1 outname_1 weight_1 [input_2 outname_2 weight_2 ...]
+
+# Parameters
+#	input
+#		The NUISANCE file to be turned into a CONVENIENT file, relative to
+#		the current directory
+#	outname
+#		The name of the output file. Must end in ".root"
+#	element_abundance_weight
+#		A weight that contributes to the "event_weight". See
+#		make_convenient_from_nuisance.C.
+#	composite_outname
+#		The name of the CONVENIENT file for the whole composite target
+#	input_i, outname_i, weight_i
+#		The NUISANCE file, unweighted CONVENIENT file, and fractional
+#		composition of each element of the composite target. Each input is
+#		read once. See make_convenient_composite_from_nuisance.C.
+
+# Outputs
+#	$outname
+#		The CONVENIENT file created from the NUISANCE file
+#	$composite_outname, $outname_i
+#		For a composite target, the CONVENIENT file for the whole target and
+#		the unweighted CONVENIENT file of each element
+
+# She-bang!
+#!/bin/bash
+
+if [ -x "${CONVENIENT_BIN_DIR}/convenient_from_nuisance" ];
+then
+	${CONVENIENT_BIN_DIR}/convenient_from_nuisance "$@"
+	exit $?
+fi
+
+echo "Compiled converter not found in ${CONVENIENT_BIN_DIR}, using the ROOT macro instead..."
+if [[ $1 == "--composite" ]];
+then
+	composite_outname=$2
+	shift 2
+	# Turn the (input, outname, weight) triplets into space-separated lists
+	inputs=""
+	outnames=""
+	weights=""
+	while [ $# -ge 3 ];
+	do
+		inputs+="$1 "
+		outnames+="$2 "
+		weights+="$3 "
+		shift 3
+	done
+	root -q "${CONVENIENT_NUISANCE_DIR}/make_convenient_composite_from_nuisance.C(\"${inputs}\", \"${outnames}\", \"${weights}\", \"${composite_outname}\")"
+else
+	input=$1
+	outname=$2
+	element_abundance_weight=$3
+	root -q "${CONVENIENT_NUISANCE_DIR}/make_convenient_from_nuisance.C(\"${input}\", \"${outname}\", ${element_abundance_weight})"
+fi
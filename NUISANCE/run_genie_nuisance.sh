@@ -36,6 +36,9 @@
 #		The NUISANCE file created from the input GENIE file.
 
 
+# For timed_stage
+source $CONVENIENT_DIR/documentation_generation_scripts/telemetry.sh
+
 # Build NUISANCE
 echo "Building NUISANCE..."
 source ${10}
@@ -54,7 +57,7 @@ nuisflat_input=GENIE:$2
 
 # Prepare the GENIE output by attaching additional xsec data to it
 echo "Running PrepareGENIE on GENIE output..."
-PrepareGENIE \
+timed_stage PrepareGENIE PrepareGENIE \
 	-i $2 \
 	-f $4 \
 	-t $target_comp
@@ -62,7 +65,7 @@ echo "PrepareGENIE complete."
 
 # Flatten the GENIE tree
 echo "Running nuisflat on prepared GENIE output..."
-nuisflat \
+timed_stage nuisflat nuisflat \
 	-i $nuisflat_input \
 	-f $NUISFLAT_FORMAT \
 	-o $8
@@ -31,6 +31,9 @@
 #		The NUISANCE output file. One is created for each element in the 
 #		target.
 
+# For timed_stage
+source $CONVENIENT_DIR/documentation_generation_scripts/telemetry.sh
+
 # Build NUISANCE
 echo "Building NUISANCE..."
 source $NEUT_NUISANCE_SETUP_SHELL
@@ -63,7 +66,7 @@ do
 
 	# Prepare the NEUT output by appending flux and event count spectra
 	echo "Running PrepareNEUT on NEUT output..."
-	PrepareNEUT \
+	timed_stage PrepareNEUT PrepareNEUT \
 		-i $raw_neut_file \
 		-f $prepareneut_flux_input \
 		-G
@@ -74,7 +77,7 @@ do
 
 	# Flatten the prepared NEUT output
 	echo "Running nuisflat on prepared NEUT output..."
-	nuisflat \
+	timed_stage nuisflat nuisflat \
 		-i $nuisflat_input \
 		-f $NUISFLAT_FORMAT \
 		-o $nuisflat_output
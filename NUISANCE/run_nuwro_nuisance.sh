@@ -34,6 +34,9 @@
 #	-o
 #		The NUISANCE file created from the input NuWro file.
 
+# For timed_stage
+source $CONVENIENT_DIR/documentation_generation_scripts/telemetry.sh
+
 # Build NUISANCE
 echo "Building NUISANCE..."
 source $NUWRO_NUISANCE_SETUP_SHELL
@@ -44,14 +47,14 @@ nuisflat_input=NuWro:$2
 
 # Prepare the NuWro output by appending flux and event count spectra
 echo "Running PrepareNuWroEvents on NuWro output..."
-PrepareNuWroEvents \
+timed_stage PrepareNuWroEvents PrepareNuWroEvents \
 	-F $4 \
 	$2
 echo "Prepare NuWroEvents complete."
 
 # Flatten the prepared NuWro output
 echo "Running nuisflat on prepared NuWro output..."
-nuisflat \
+timed_stage nuisflat nuisflat \
 	-i $nuisflat_input \
 	-f $NUISFLAT_FORMAT \
 	-o $6
@@ -46,6 +46,9 @@
 # She-bang!
 #!/bin/bash
 
+# For timed_stage
+source $CONVENIENT_DIR/documentation_generation_scripts/telemetry.sh
+
 # Read the inputs
 nuwro_config=$2
 nuwro_flux_file=$4
@@ -54,6 +57,10 @@ nuwro_seed=$8
 nuwro_target=${10}
 nuwro_rel_target=${nuwro_target/$CONVENIENT_TAR_DIR\//}
 
+# The events and seed of this shard, if any (see run_shard in run.sh)
+nuwro_n_events=${CONVENIENT_SHARD_EVENTS:-$N_EVENTS}
+nuwro_generator_seed=${CONVENIENT_SHARD_SEED:-$nuwro_seed}
+
 # In $config, separate out params file from directory
 params=${nuwro_config#*/} # Params is everything after the /
 
@@ -95,12 +102,12 @@ echo "Generating and processing NuWro w/ params $params..."
 bash run_nuwro.sh \
 	-o $filename_raw \
 	-i $nuwro_config \
-	-n $N_EVENTS \
+	-n $nuwro_n_events \
 	-p $NEUTRINO_PDG \
 	--flux_file $nuwro_flux_file \
 	--flux_histo $nuwro_flux_histo \
 	-t $nuwro_target \
-	--seed $nuwro_seed
+	--seed $nuwro_generator_seed
 
 # Run NUISANCE on the output from above.
 # Format is (for a beam with only one neutrino flavor)
@@ -115,7 +122,7 @@ bash $CONVENIENT_NUISANCE_DIR/run_nuwro_nuisance.sh \
 	-o $filename_nuisance
 
 # Post-process the NUISANCE output to output the Convenient file 
-root -q "${CONVENIENT_NUISANCE_DIR}/make_convenient_from_nuisance.C(\"${filename_nuisance}\", \"${filename_convenient}\", 1)"
+timed_stage convert bash ${CONVENIENT_NUISANCE_DIR}/make_convenient_from_nuisance.sh "${filename_nuisance}" "${filename_convenient}" 1
 
 # Move the output files to the folders matching the program that 
 # created them.
@@ -147,5 +154,5 @@ fi
 mkdir -p $nuisance_output_dir/$filepath
 mkdir -p $convenient_output_dir/$filepath
 # mv format is [file to move] [new directory and/or name]
-mv $filename_nuisance $nuisance_output_dir/$filepath/$filename_nuisance
-mv $filename_convenient $convenient_output_dir/$filepath/$filename_convenient
+timed_stage move mv $filename_nuisance $nuisance_output_dir/$filepath/$filename_nuisance
+timed_stage move mv $filename_convenient $convenient_output_dir/$filepath/$filename_convenient
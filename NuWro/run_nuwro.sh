@@ -45,6 +45,9 @@
 # She-bang!
 #!/bin/bash
 
+# For timed_stage
+source $CONVENIENT_DIR/documentation_generation_scripts/telemetry.sh
+
 ## Create the beam energy parameter
 	# Construct the file name
 	beam_filename_tmp=${10/$CONVENIENT_DIR\//}
@@ -54,11 +57,9 @@
 	# Construct the full file path
 	nuwro_beam_filepath="$CONVENIENT_DIR/NuWro/beam_energies/"$beam_filename"."$original_flux_histo".txt"
 
-	# Check if the beam energy has already been created. If not, create it.
-	if [ ! -f "$nuwro_beam_filepath" ];
-	then
-		root -q "make_beam_energy.C(\"${10}\", \"${12}\", \"${nuwro_beam_filepath}\")"
-	fi
+	# Make sure the beam energy exists and is up to date. The flux exporter 
+	# writes the fluxes of all the generators at once, and caches them.
+	bash $CONVENIENT_DIR/flux/export_flux.sh -f "${10}" -h "${12}" || exit 1
 
 	# Read in the beam energy content
 	beam_energy=$(<"$nuwro_beam_filepath")
@@ -146,7 +147,7 @@
 ### Generate NuWro events by inputting a general parameters file, then 
 ### modifying certain parameters as necessary. Target content has already 
 ### been set in the parameters file, and beam energy is defined above.
-nuwro \
+timed_stage nuwro nuwro \
 	-o $2 \
 	-i $4 \
 	-p "number_of_events = $6" \
@@ -0,0 +1,236 @@
+# Author: Colin Weber (webe1077@umn.edu)
+# Date: 16 October 2026
+# Purpose: To time the whole CONVENIENT chain on synthetic inputs, on any
+# machine with ROOT, so that the effect of a change on performance can be
+# measured, and checked for regressions, without any generator or NUISANCE
+# install. The stages are:
+#	fixtures			Make the synthetic inputs (make_synthetic_inputs.C)
+#	convert_nuisance	NUISANCE -> CONVENIENT (make_convenient_from_nuisance.sh)
+#	convert_gibuu		GiBUU -> CONVENIENT (make_convenient_from_gibuu.C)
+#	reweight			Reweight the NUISANCE output, baking the weight into
+#						every event (make_convenient_from_convenient_reweight.C)
+#	merge				Merge the NUISANCE output and its reweighted copy as
+#						runs (make_convenient_from_convenient.C)
+#	convert_composite	NUISANCE -> CONVENIENT for a composite target of
+#						carbon and hydrogen, each with its own generator
+#						scale factor (make_convenient_composite_from_nuisance.C)
+#	merge_parts			Merge the unweighted carbon and hydrogen files as
+#						parts with their fractions, which reweights every
+#						event rather than copying the baskets
+#	merge_composite		Merge two copies of the composite as runs, as
+#						run.sh does with the shards of a NOvA ND run
+#	analysis			Run a numu CC analysis over the three outputs
+#						(benchmark_analysis.C)
+# For each stage, the wall time, the events and MB read per second, and the
+# peak memory are recorded, along with the checksum of what the stage made
+# (see checksum_convenient.C). The inputs are made with a fixed seed, so the
+# checksums of two runs with the same number of events must be identical;
+# a different checksum means that a change altered the outputs.
+
+# Command: bash run_benchmarks.sh [-n n_events] [-o results] [-d work_dir]
+#	[-b baseline -t threshold]
+
+# Parameters
+#	-n
+#		The number of events in each synthetic input. Defaults to 200000.
+#	-o
+#		The file to write the results to. Defaults to
+#		benchmark_results.tsv in the current directory.
+#	-d
+#		Where to write the inputs and outputs of the stages. Defaults to a
+#		new temporary directory, which is removed at the end.
+#	-b
+#		The results of an earlier run to compare against. A stage fails if
+#		its checksum differs from the baseline, or if its events per second
+#		are lower than the baseline's by more than the threshold.
+#	-t
+#		The threshold of -b, in percent. Defaults to 10.
+
+# Outputs
+#	$results
+#		A tab-separated table with one line per stage, with the columns
+#		stage, events, seconds, events_per_s, MB_per_s, peak_rss_kB, and
+#		checksum. Values that could not be measured are NA.
+#	The exit status is 1 if any stage failed, or regressed with respect to
+#	the baseline, and 0 otherwise.
+
+# She-bang!
+#!/bin/bash
+
+n_events=200000
+results="$(pwd)/benchmark_results.tsv"
+work_dir=""
+baseline=""
+threshold=10
+while [ $# -ge 2 ];
+do
+	case $1 in
+		-n) n_events=$2 ;;
+		-o) results=$(realpath -m "$2") ;;
+		-d) work_dir=$(realpath -m "$2") ;;
+		-b) baseline=$(realpath -m "$2") ;;
+		-t) threshold=$2 ;;
+		*) echo "Unknown option $1" >&2; exit 1 ;;
+	esac
+	shift 2
+done
+
+# Everything the stages need is in this repository, so set it up here if
+# setup_convenient.sh hasn't been sourced
+benchmark_dir="$( cd "$( dirname "${BASH_SOURCE[0]}" )" && pwd )"
+export CONVENIENT_DIR=${CONVENIENT_DIR:-$(dirname "$benchmark_dir")}
+export CONVENIENT_NUISANCE_DIR=${CONVENIENT_NUISANCE_DIR:-$CONVENIENT_DIR/NUISANCE}
+export CONVENIENT_BIN_DIR=${CONVENIENT_BIN_DIR:-$CONVENIENT_DIR/build/bin}
+export ROOT_INCLUDE_PATH=$CONVENIENT_DIR/include${ROOT_INCLUDE_PATH:+:$ROOT_INCLUDE_PATH}
+gibuu_dir=$CONVENIENT_DIR/GiBUU
+
+if ! command -v root > /dev/null;
+then
+	echo "ROOT is not set up!  Aborting." >&2
+	exit 1
+fi
+
+if [ -z "$work_dir" ];
+then
+	work_dir=$(mktemp -d)
+	trap 'rm -rf "$work_dir"' EXIT
+fi
+mkdir -p "$work_dir"
+cd "$work_dir"
+
+# GNU time gives the peak memory. Without it, only the wall time is
+# measured.
+if [ -x /usr/bin/time ] && /usr/bin/time -f "%e" true 2> /dev/null;
+then
+	gnu_time=1
+else
+	gnu_time=0
+fi
+
+printf "stage\tevents\tseconds\tevents_per_s\tMB_per_s\tpeak_rss_kB\tchecksum\n" > "$results"
+failed=0
+
+# The sum of the sizes of files, in MB
+size_mb() {
+	du -cb "$@" | tail -n 1 | awk '{printf "%.3f", $1 / 1e6}'
+}
+
+# The checksum of what a ROOT file holds
+checksum() {
+	root -l -b -q "$benchmark_dir/checksum_convenient.C(\"$1\")" | \
+		awk '/^checksum: / {print $2}'
+}
+
+# Run a stage and record it. The arguments are the name of the stage, the
+# number of events it processes, the files it reads (for MB/s, as a quoted
+# space-separated list), the output file to checksum, and the command.
+run_stage() {
+	local stage=$1
+	local events=$2
+	local inputs=$3
+	local output=$4
+	shift 4
+	echo "Running $stage..."
+
+	local seconds="NA"
+	local rss="NA"
+	if [ $gnu_time -eq 1 ];
+	then
+		/usr/bin/time -f "%e %M" -o "$work_dir/$stage.time" "$@" > "$work_dir/$stage.log" 2>&1
+		local status=$?
+		# GNU time puts a line about the exit status first if it isn't 0
+		read seconds rss < <(tail -n 1 "$work_dir/$stage.time")
+	else
+		local start=$(date +%s.%N)
+		"$@" > "$work_dir/$stage.log" 2>&1
+		local status=$?
+		seconds=$(echo "$(date +%s.%N) $start" | awk '{printf "%.2f", $1 - $2}')
+	fi
+
+	if [ $status -ne 0 ] || [ ! -s "$output" ];
+	then
+		echo "$stage failed!  See $work_dir/$stage.log" >&2
+		failed=1
+		printf "%s\t%s\tNA\tNA\tNA\tNA\tNA\n" "$stage" "$events" >> "$results"
+		return 1
+	fi
+
+	local sum
+	if [[ $output == *.root ]];
+	then
+		sum=$(checksum "$output")
+	else
+		sum=$(md5sum < "$output" | cut -d ' ' -f 1)
+	fi
+	local mb=$(size_mb $inputs)
+	echo "$stage $events $seconds $mb $rss ${sum:-NA}" | awk -v OFS='\t' \
+		'{eps = ($3 > 0) ? sprintf("%.0f", $2 / $3) : "NA"; \
+		mbs = ($3 > 0) ? sprintf("%.2f", $4 / $3) : "NA"; \
+		print $1, $2, $3, eps, mbs, $5, $6}' >> "$results"
+}
+
+# The synthetic inputs. Their MB/s is of the files written, and their
+# checksum is that of the GiBUU file, which is drawn from the same random
+# numbers as the NUISANCE file.
+run_stage fixtures $n_events \
+	"synthetic_nuisance.root synthetic_FinalEvents.dat synthetic_flux.dat" \
+	synthetic_FinalEvents.dat \
+	root -l -b -q "$benchmark_dir/make_synthetic_inputs.C($n_events, \"$work_dir\", 12345)"
+
+run_stage convert_nuisance $n_events synthetic_nuisance.root nuisance.root \
+	bash "$CONVENIENT_NUISANCE_DIR/make_convenient_from_nuisance.sh" \
+	synthetic_nuisance.root nuisance.root 1.0
+
+run_stage convert_gibuu $n_events "synthetic_FinalEvents.dat synthetic_flux.dat" gibuu.root \
+	root -l -b -q "$gibuu_dir/make_convenient_from_gibuu.C(\"synthetic_FinalEvents.dat\", \"synthetic_flux.dat\", \"14\", \"CC\", \"6\", \"12\", \"gibuu.root\", \"1.0\")"
+
+run_stage reweight $n_events nuisance.root reweighted.root \
+	root -l -b -q "$CONVENIENT_NUISANCE_DIR/make_convenient_from_convenient_reweight.C(\"nuisance.root\", \"reweighted.root\", \"0.5\", true)"
+
+run_stage merge $((2 * n_events)) "nuisance.root reweighted.root" merged.root \
+	root -l -b -q "$CONVENIENT_NUISANCE_DIR/make_convenient_from_convenient.C(\"nuisance.root reweighted.root\", \"merged.root\", \"runs\", 0, \"\")"
+
+run_stage convert_composite $((3 * n_events / 2)) \
+	"synthetic_nuisance.root synthetic_nuisance_H1.root" composite.root \
+	root -l -b -q "$CONVENIENT_NUISANCE_DIR/make_convenient_composite_from_nuisance.C(\"synthetic_nuisance.root synthetic_nuisance_H1.root\", \"composite_C12.root composite_H1.root\", \"0.8 0.2\", \"composite.root\")"
+
+# The elements have different fractions, so the events can't be copied
+# as they are, and each one is reweighted as it is written
+run_stage merge_parts $((3 * n_events / 2)) \
+	"composite_C12.root composite_H1.root" merged_parts.root \
+	root -l -b -q "$CONVENIENT_NUISANCE_DIR/make_convenient_from_convenient.C(\"composite_C12.root composite_H1.root\", \"merged_parts.root\", \"parts\", 0, \"0.8 0.2\")"
+
+# The shards of a run are copies here, so each is half of the merged run
+cp composite.root composite_shard1.root 2> /dev/null
+run_stage merge_composite $((3 * n_events)) "composite.root composite_shard1.root" merged_composite.root \
+	root -l -b -q "$CONVENIENT_NUISANCE_DIR/make_convenient_from_convenient.C(\"composite.root composite_shard1.root\", \"merged_composite.root\", \"runs\", 0, \"\")"
+
+run_stage analysis $((4 * n_events)) "nuisance.root gibuu.root merged.root" analysis.root \
+	root -l -b -q "$benchmark_dir/benchmark_analysis.C(\"nuisance.root gibuu.root merged.root\", \"analysis.root\", 0)"
+
+column -t -s $'\t' "$results" 2> /dev/null || cat "$results"
+
+# Compare against the baseline
+if [ -n "$baseline" ];
+then
+	echo "Comparing with $baseline (threshold $threshold%)..."
+	awk -F '\t' -v threshold=$threshold '
+		FNR == 1 { next }
+		NR == FNR { base_eps[$1] = $4; base_sum[$1] = $7; next }
+		!($1 in base_eps) { next }
+		{
+			status = "ok"
+			if($7 != base_sum[$1]) status = "CHANGED OUTPUT"
+			else if($4 == "NA") status = "FAILED"
+			else if(base_eps[$1] != "NA" && \
+				$4 < base_eps[$1] * (1 - threshold / 100)) status = "SLOWER"
+			change = (base_eps[$1] > 0 && $4 != "NA") ? \
+				sprintf("%+.1f%%", 100 * ($4 / base_eps[$1] - 1)) : "NA"
+			printf "%-18s %12s -> %12s events/s (%s)  %s\n", $1, \
+				base_eps[$1], $4, change, status
+			if(status != "ok") bad = 1
+		}
+		END { exit bad }' "$baseline" "$results" || failed=1
+fi
+
+exit $failed
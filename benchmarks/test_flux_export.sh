@@ -0,0 +1,140 @@
+# Author: Colin Weber (webe1077@umn.edu)
+# Date: 16 October 2026
+# Purpose: To check flux/export_flux.sh and flux/make_generator_fluxes.C
+# end to end, on any machine with ROOT. A synthetic flux histogram is
+# exported to all four generator formats, which are then read back and
+# compared with it (see check_flux_export.C). Then the flux is exported
+# again, which must be a cache hit that rewrites nothing, and once more
+# after the flux file has changed, which must be a cache miss that writes
+# the new flux.
+
+# Command: bash test_flux_export.sh [-d work_dir]
+
+# Parameters
+#	-d
+#		Where to export the flux. It is used as CONVENIENT_DIR by
+#		export_flux.sh, so nothing is written into the repository.
+#		Defaults to a new temporary directory, which is removed at the end.
+
+# Outputs
+#	The exit status is 1 if any check failed, and 0 otherwise. The log of
+#	each step is kept in work_dir.
+
+# She-bang!
+#!/bin/bash
+
+work_dir=""
+while [ $# -ge 2 ];
+do
+	case $1 in
+		-d) work_dir=$(realpath -m "$2") ;;
+		*) echo "Unknown option $1" >&2; exit 1 ;;
+	esac
+	shift 2
+done
+
+benchmark_dir="$( cd "$( dirname "${BASH_SOURCE[0]}" )" && pwd )"
+repo_dir=$(dirname "$benchmark_dir")
+
+if ! command -v root > /dev/null;
+then
+	echo "ROOT is not set up!  Aborting." >&2
+	exit 1
+fi
+
+if [ -z "$work_dir" ];
+then
+	work_dir=$(mktemp -d)
+	trap 'rm -rf "$work_dir"' EXIT
+fi
+
+# export_flux.sh writes into the generator directories of CONVENIENT_DIR,
+# so give it one of its own with just the flux macro
+export CONVENIENT_DIR=$work_dir
+mkdir -p "$CONVENIENT_DIR/flux"
+cp "$repo_dir/flux/make_generator_fluxes.C" "$CONVENIENT_DIR/flux/"
+
+flux_file="$CONVENIENT_DIR/flux/test_flux.root"
+flux_histo=test_flux
+flux_filename=flux_test_flux.root.$flux_histo
+neut_txt="$CONVENIENT_DIR/NEUT/beam_energies/$flux_filename.txt"
+neut_root="$CONVENIENT_DIR/NEUT/beam_energies/$flux_filename.root"
+gibuu_dat="$CONVENIENT_DIR/GiBUU/beam_energies/$flux_filename.dat"
+nuwro_txt="$CONVENIENT_DIR/NuWro/beam_energies/$flux_filename.txt"
+outputs="$neut_txt $neut_root $gibuu_dat $nuwro_txt $CONVENIENT_DIR/flux/exports/$flux_filename.md5"
+failed=0
+
+# Write the flux with the given scale
+write_flux() {
+	root -l -b -q "$benchmark_dir/check_flux_export.C(\"write\", \"$flux_file\", $1)" \
+		> "$work_dir/write_$1.log" 2>&1
+}
+
+# Export the flux, logging to the given name
+export_flux() {
+	if ! bash "$repo_dir/flux/export_flux.sh" -f "$flux_file" -h $flux_histo \
+		> "$work_dir/$1.log" 2>&1;
+	then
+		echo "FAILED: export_flux.sh failed ($1).  See $work_dir/$1.log"
+		failed=1
+	fi
+}
+
+# Check the exported files against the flux with the given scale
+check_flux() {
+	root -l -b -q "$benchmark_dir/check_flux_export.C(\"check\", \"$flux_file\", $1, \"$neut_txt\", \"$neut_root\", \"$gibuu_dat\", \"$nuwro_txt\")" \
+		> "$work_dir/$2.log" 2>&1
+	if grep -q "^flux export check: passed" "$work_dir/$2.log";
+	then
+		echo "ok: $2"
+	else
+		echo "FAILED: $2.  See $work_dir/$2.log"
+		grep -v "^flux export check" "$work_dir/$2.log" | tail -n 20
+		failed=1
+	fi
+}
+
+# The number of outputs changed since the marker file was made
+n_newer() {
+	find $outputs -newer "$work_dir/marker" 2> /dev/null | wc -l
+}
+
+# Export a new flux, and read every format back
+write_flux 1
+export_flux first_export
+check_flux 1 round_trip
+
+# The same flux again is a cache hit, which rewrites nothing
+touch "$work_dir/marker"
+sleep 1
+export_flux cache_hit
+if [ $(n_newer) -eq 0 ] && ! grep -q "make_generator_fluxes" "$work_dir/cache_hit.log";
+then
+	echo "ok: cache hit"
+else
+	echo "FAILED: the unchanged flux was exported again"
+	failed=1
+fi
+
+# A changed flux file is a cache miss, which rewrites every output
+sleep 1
+touch "$work_dir/marker"
+sleep 1
+write_flux 2
+export_flux cache_miss
+if [ $(n_newer) -eq 5 ];
+then
+	echo "ok: cache miss"
+else
+	echo "FAILED: the changed flux did not rewrite every output"
+	failed=1
+fi
+check_flux 2 round_trip_after_change
+
+if [ $failed -eq 0 ];
+then
+	echo "Every flux export check passed."
+else
+	echo "Some flux export checks failed!" >&2
+fi
+exit $failed
@@ -0,0 +1,157 @@
+# Author: Colin Weber (webe1077@umn.edu)
+# Date: 16 October 2026
+# Purpose: To record a CONVENIENT output in the catalog of all the outputs,
+# ConvenientCatalog.tsv. The catalog has one line per output, with the
+# columns
+#	generator version tune flux flux_file flux_histo flavor target seed
+#	n_events nova_switch write_policy date file
+# separated by tabs, so that it can be queried quickly (see
+# query_catalog.sh) and run.sh can tell which runs already exist. Everything
+# is read from the .txt file accompanying the output (see
+# create_output_txt_file.sh) and from where the output is, so the catalog
+# can also be rebuilt from the outputs that already exist.
+
+# Command: bash add_to_catalog.sh [-i output .txt file]
+# or, to rebuild the whole catalog from the outputs,
+#	bash add_to_catalog.sh --rebuild
+
+# Parameters
+#	-i
+#		The .txt file accompanying the CONVENIENT output to record. The
+#		output must be in $CONVENIENT_OUTPUT_DIR or
+#		$CONVENIENT_NOvA_OUTPUT_DIR, in the directory structure made by the
+#		conveniently_run_*.sh scripts.
+#	--rebuild
+#		Rebuild the catalog from the .txt files of all the outputs in
+#		$CONVENIENT_OUTPUT_DIR and $CONVENIENT_NOvA_OUTPUT_DIR
+
+# Outputs
+#	$CONVENIENT_DIR/ConvenientCatalog.tsv
+#		The catalog. An output that is recorded again replaces its old line.
+#		The file is given relative to $CONVENIENT_NOvA_OUTPUT_DIR if
+#		nova_switch is 1, and to $CONVENIENT_OUTPUT_DIR otherwise. flux_file
+#		is the name of the flux file, without its directory. The write
+#		policy of an output whose .txt file predates it is "unknown", so
+#		that run.sh never takes it for a run with a given policy. A catalog
+#		with other columns, made before them, is rebuilt.
+
+# She-bang!
+#!/bin/bash
+
+catalog=$CONVENIENT_DIR/ConvenientCatalog.tsv
+catalog_header="#generator	version	tune	flux	flux_file	flux_histo	flavor	target	seed	n_events	nova_switch	write_policy	date	file"
+
+# Form the catalog line of an output from its .txt file
+# Format is catalog_line txt_file
+catalog_line() {
+	local txt_file=$1
+	local file=${txt_file%.txt}.root
+	local nova_switch rel
+
+	# Get the path of the output within its output directory
+	if [[ $file == $CONVENIENT_NOvA_OUTPUT_DIR/* ]];
+	then
+		nova_switch=1
+		rel=${file#$CONVENIENT_NOvA_OUTPUT_DIR/}
+	elif [[ $file == $CONVENIENT_OUTPUT_DIR/* ]];
+	then
+		nova_switch=0
+		rel=${file#$CONVENIENT_OUTPUT_DIR/}
+	else
+		echo "$file is not in an output directory, so it can't be cataloged." >&2
+		return 1
+	fi
+
+	# Read the values from the .txt file. If a value was written more than
+	# once, the last one counts.
+	local n_events=$(sed -n 's/^N_EVENTS=\([0-9]*\).*/\1/p' $txt_file | tail -n 1)
+	local seed=$(sed -n 's/^SEED=\([0-9]*\).*/\1/p' $txt_file | tail -n 1)
+	local version=$(sed -n 's/^GENERATOR_VERSION=//p' $txt_file | tail -n 1)
+	local date=$(sed -n 's/^DATE=//p' $txt_file | tail -n 1)
+	local soup=$(sed -n 's/^\(GENIE_ND_SOUP\|TARGET\)=//p' $txt_file | tail -n 1)
+	local flux_file=$(sed -n 's/^FLUX_FILE=//p' $txt_file | tail -n 1)
+	flux_file=${flux_file##*/}
+	local flux_histo=$(sed -n 's/^FLUX_HISTO=//p' $txt_file | tail -n 1)
+	local write_policy=$(sed -n 's/^WRITE_POLICY=//p' $txt_file | tail -n 1)
+
+	# The directory structure is
+	# generator/version_tune/HCflux/flavor_only[/element]/file
+	local generator tune_dir flux flavor_dir element
+	IFS='/' read -r generator tune_dir flux flavor_dir element <<< "${rel%/*}"
+	local tune=${tune_dir#${version}_}
+	local flavor=${flavor_dir%_only}
+
+	# Outputs with the NOvA ND weights applied are for the whole target
+	# composition, and the others for a single element
+	local target
+	if [ $nova_switch -eq 1 ];
+	then
+		target=${soup##*/targets/}
+		target=${target#$CONVENIENT_TAR_DIR/}
+	else
+		target=$element
+	fi
+
+	if [ -z "$generator" ] || [ -z "$flux" ] || [ -z "$flavor" ] || \
+		[ -z "$target" ] || [ -z "$seed" ] || [ -z "$n_events" ] || \
+		[ -z "$flux_file" ] || [ -z "$flux_histo" ];
+	then
+		echo "Could not read the configuration of $file, so it can't be cataloged." >&2
+		return 1
+	fi
+	printf "%s\t%s\t%s\t%s\t%s\t%s\t%s\t%s\t%s\t%s\t%s\t%s\t%s\t%s\n" \
+		$generator $version $tune $flux $flux_file $flux_histo $flavor \
+		$target $seed $n_events $nova_switch ${write_policy:-unknown} \
+		"$date" $rel
+}
+
+# Rebuild the catalog from the .txt files of all the outputs
+rebuild_catalog() {
+	echo "Rebuilding $catalog..."
+	local new_catalog=$catalog.new
+	echo "$catalog_header" > $new_catalog
+	while IFS= read -r txt_file
+	do
+		if [ -f "${txt_file%.txt}.root" ];
+		then
+			catalog_line $txt_file
+		fi
+	done <<< "$(find $CONVENIENT_OUTPUT_DIR $CONVENIENT_NOvA_OUTPUT_DIR \
+		-name "*.txt" 2>/dev/null)" | sort >> $new_catalog
+	mv $new_catalog $catalog
+	echo "Cataloged $(grep -v -c '^#' $catalog) outputs."
+}
+
+# Lock the catalog until this script exits (see append_telemetry in 
+# telemetry.sh)
+exec 9> "$catalog.lock"
+flock 9
+
+if [ "$1" == "--rebuild" ];
+then
+	rebuild_catalog
+	exit 0
+fi
+
+line=$(catalog_line $2) || exit 1
+if [ ! -f $catalog ];
+then
+	echo "$catalog_header" > $catalog
+elif [ "$(head -n 1 $catalog)" != "$catalog_header" ];
+then
+	rebuild_catalog
+fi
+
+# Replace any old line for the same file, and keep the lines sorted so that
+# the outputs of a configuration are next to each other
+file=${line##*$'\t'}
+nova_switch=$(echo "$line" | cut -f 11)
+{
+	echo "$catalog_header"
+	awk -F '\t' -v file="$file" -v nova="$nova_switch" \
+		'!/^#/ && !($14 == file && $11 == nova)' $catalog
+	echo "$line"
+} > $catalog.new
+{ head -n 1 $catalog.new; tail -n +2 $catalog.new | sort; } > $catalog.sorted
+mv $catalog.sorted $catalog
+rm $catalog.new
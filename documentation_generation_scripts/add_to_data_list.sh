@@ -12,6 +12,13 @@
 # She-bang!
 #!/bin/bash
 
+# The shards of a sharded run (see run.sh) are documented once, after they 
+# have been merged
+if [ -n "$CONVENIENT_SHARD" ];
+then
+	exit 0
+fi
+
 # Define a function that places an input string alphabetically between lines 
 # l0 and l1 in the output file.
 # Format is place_alphabetically str_type string l0 l1 output
@@ -197,6 +204,11 @@ else
 	target_string="___Target:$target"
 fi
 
+# Lock the output file until this script exits (see append_telemetry in 
+# telemetry.sh)
+exec 9> "$output_file.lock"
+flock 9
+
 # Get the number of lines in the output file
 n_lines=$(wc -l < $output_file)
 
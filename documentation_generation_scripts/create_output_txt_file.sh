@@ -10,18 +10,26 @@
 #	[-p neutrino pdg] [-f flux file,flux histogram]
 # 	[-t path to file containing target composition in GENIE form]
 # 	[-d date in yyyymmddhhmmss format] [-v genereator version]
-# 	[--seed MC seed]
+# 	[--seed MC seed] [--telemetry file of the stages of the run]
 
 # Outputs
 #	file
 #		a .txt file decribing how the associated CONVENIENT file was made. 
 #		It's located in the same directory as the CONVENIENT file and has 
 #		the same file name, except the extension is changed from .root to 
-#		.txt
+#		.txt. If --telemetry is given, it ends with the time, CPU, memory, 
+#		and I/O of each stage of the run recorded so far (see telemetry.sh)
 
 # She-bang!
 #!/bin/bash
 
+# The shards of a sharded run (see run.sh) are documented once, after they 
+# have been merged
+if [ -n "$CONVENIENT_SHARD" ];
+then
+	exit 0
+fi
+
 # Create the text file. The directory will already have been made
 filepath_filename=$2 # Read the input
 abs_filepath=${filepath_filename%,*} 
@@ -94,3 +102,23 @@ echo "" >> $file
 
 # Add the generator version
 echo "GENERATOR_VERSION=${16}" >> $file
+echo "" >> $file
+
+# Add the write policy, which the converters read from the environment
+echo "WRITE_POLICY=${CONVENIENT_WRITE_POLICY:-default}" >> $file
+
+# Add the cost of each stage of the run, one line per stage
+telemetry_file=${20}
+if [ -n "$telemetry_file" ] && [ -s "$telemetry_file" ];
+then
+	echo "" >> $file
+	echo "# The stages of the run (see documentation_generation_scripts/telemetry.sh)" >> $file
+	awk -F '\t' '!/^#/ {
+		printf "STAGE=%s SHARD=%s EVENTS=%s WALL_S=%s CPU_S=%s PEAK_RSS_KB=%s ", \
+			$8, $6, $9, $11, $12, $13
+		printf "BYTES_READ=%s BYTES_WRITTEN=%s EVENTS_PER_S=%s STATUS=%s HOST=%s\n", \
+			$14, $15, $16, $10, $7}' "$telemetry_file" >> $file
+fi
+
+# Record the output in the catalog of all the outputs
+bash $CONVENIENT_DIR/documentation_generation_scripts/add_to_catalog.sh -i $file
@@ -0,0 +1,144 @@
+# Author: Colin Weber (webe1077@umn.edu)
+# Date: 16 October 2026
+# Purpose: To list the CONVENIENT outputs in the catalog,
+# ConvenientCatalog.tsv (see add_to_catalog.sh), that match a
+# configuration. Every option narrows down the list, and any that is left
+# out matches everything.
+
+# Command: bash query_catalog.sh
+#	[--generator generator] [--version generator version]
+#	[--tune tune/parameter file] [--flux HC and flux]
+#	[--flux_file flux file name] [--flux_histo flux histogram]
+#	[--flavor flavor] [--target target] [--seed MC seed]
+#	[--n_events number of events] [--nova_switch 1=used ND element weights]
+#	[--write_policy write policy] [--existing] [--paths]
+
+# Parameters
+#	--generator
+#		One of {GENIE, NuWro, NEUT, GiBUU}
+#	--version
+#		The generator version, e.g. v3.04.00
+#	--tune
+#		The tune or parameter file, without its extension, e.g.
+#		Defaultparams
+#	--flux
+#		The horn current polarity followed by the flux, e.g.
+#		RHCDeriveFlux50MeVwidth_ppfx
+#	--flux_file
+#		The name of the flux file, without its directory
+#	--flux_histo
+#		The flux histogram within the flux file
+#	--flavor
+#		The flavor, e.g. numubar, with CC or NC appended for GiBUU
+#	--target
+#		For nova_switch 1, the target composition file relative to
+#		$CONVENIENT_TAR_DIR, e.g. NOvA_ND/NDTargetComposition_GENIE_2.txt.
+#		Otherwise, the element, e.g. C12.
+#	--seed
+#		The MC seed
+#	--n_events
+#		The number of events
+#	--nova_switch
+#		1 for the outputs with the NOvA ND element weights applied, 0 for
+#		the others
+#	--write_policy
+#		The write policy of the output (see set_run_variables.sh)
+#	--existing
+#		Only list the outputs whose files still exist
+#	--paths
+#		Print only the full path of each output, instead of its catalog line
+
+# Outputs
+#	The matching lines of the catalog, or the paths of the matching outputs
+
+# She-bang!
+#!/bin/bash
+
+catalog=$CONVENIENT_DIR/ConvenientCatalog.tsv
+
+# Read the options. Each filter is the value to match in one column of the
+# catalog.
+declare -A filters
+existing=0
+paths=0
+while [ $# -gt 0 ];
+do
+	case $1 in
+		--generator) filters[1]=$2; shift 2 ;;
+		--version) filters[2]=$2; shift 2 ;;
+		--tune) filters[3]=$2; shift 2 ;;
+		--flux) filters[4]=$2; shift 2 ;;
+		--flux_file) filters[5]=$2; shift 2 ;;
+		--flux_histo) filters[6]=$2; shift 2 ;;
+		--flavor) filters[7]=$2; shift 2 ;;
+		--target) filters[8]=$2; shift 2 ;;
+		--seed) filters[9]=$2; shift 2 ;;
+		--n_events) filters[10]=$2; shift 2 ;;
+		--nova_switch) filters[11]=$2; shift 2 ;;
+		--write_policy) filters[12]=$2; shift 2 ;;
+		--existing) existing=1; shift ;;
+		--paths) paths=1; shift ;;
+		*)
+			echo "Unknown option $1" >&2
+			exit 1
+			;;
+	esac
+done
+
+if [ ! -f $catalog ];
+then
+	exit 0
+fi
+
+# A catalog made before some of the columns existed can't be matched
+# column by column
+if [ "$(head -n 1 $catalog | cut -f 5)" != "flux_file" ];
+then
+	echo "$catalog is out of date. Rebuild it with add_to_catalog.sh --rebuild." >&2
+	exit 0
+fi
+
+# Pass the filters to awk as "column=value" pairs, separated by tabs
+filter_string=""
+for column in "${!filters[@]}"
+do
+	filter_string+="$column=${filters[$column]}"$'\t'
+done
+
+awk -F '\t' -v filters="$filter_string" '
+	BEGIN {
+		n = split(filters, pairs, "\t")
+		for(i = 1; i <= n; i++) {
+			if(pairs[i] == "") continue
+			eq = index(pairs[i], "=")
+			wanted[substr(pairs[i], 1, eq - 1)] = substr(pairs[i], eq + 1)
+		}
+	}
+	/^#/ { next }
+	{
+		for(column in wanted) {
+			if($column != wanted[column]) next
+		}
+		print
+	}' $catalog | \
+while IFS= read -r line
+do
+	nova_switch=$(echo "$line" | cut -f 11)
+	file=$(echo "$line" | cut -f 14)
+	if [ $nova_switch -eq 1 ];
+	then
+		path=$CONVENIENT_NOvA_OUTPUT_DIR/$file
+	else
+		path=$CONVENIENT_OUTPUT_DIR/$file
+	fi
+	if [ $existing -eq 1 ] && [ ! -f "$path" ];
+	then
+		continue
+	fi
+	if [ $paths -eq 1 ];
+	then
+		echo "$path"
+	else
+		echo "$line"
+	fi
+done
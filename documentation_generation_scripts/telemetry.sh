@@ -0,0 +1,130 @@
+# Author: Colin Weber (webe1077@umn.edu)
+# Date: 16 October 2026
+# Purpose: To measure what each stage of a CONVENIENT run (generating the
+# events, running NUISANCE, converting, merging, and moving the outputs)
+# costs, so that batch nodes can be sized and the slowest stages found.
+# Sourcing this file defines timed_stage, which runs a command and records
+# its wall time, CPU time (user + system, including every process it
+# starts), peak memory, the bytes it read and wrote, and its events per
+# second. Each stage is recorded twice:
+#	$CONVENIENT_TELEMETRY_FILE
+#		The stages of the current run entry, which create_output_txt_file.sh
+#		copies into the .txt file of each output of the entry. run.sh sets
+#		this to the log of each entry.
+#	$CONVENIENT_DIR/ConvenientTelemetry.tsv
+#		The stages of every run entry ever run, to be aggregated across runs
+# If CONVENIENT_TELEMETRY_FILE is not set (e.g. when a generator script is
+# run by hand), the commands are run without being recorded.
+
+# Command: source telemetry.sh
+#	timed_stage [-n n_events] stage command [arguments...]
+
+# Parameters
+#	-n
+#		The number of events the stage processes. Defaults to the events of
+#		the current shard, or N_EVENTS.
+#	stage
+#		The name of the stage, e.g. gevgen or nuisflat
+#	command
+#		The command to run. It may be a shell function, but it runs in a
+#		subshell, so it can't set variables of the calling script.
+
+# Outputs
+#	Each file above gets one tab-separated line per stage, with the columns
+#		run entry generator config seed shard host stage events status
+#		wall_s cpu_s peak_rss_kB bytes_read bytes_written events_per_s
+#	where run is the DATE of the run and the entry is its index in the run
+#	lists. peak_rss_kB is NA if GNU time isn't installed, and the bytes are
+#	NA where /proc/<pid>/io isn't available. The bytes are all those read
+#	and written by the stage, including from and to pipes.
+#	The exit status of timed_stage is that of the command.
+
+# She-bang!
+#!/bin/bash
+
+telemetry_header="#run	entry	generator	config	seed	shard	host	stage	events	status	wall_s	cpu_s	peak_rss_kB	bytes_read	bytes_written	events_per_s"
+telemetry_log=$CONVENIENT_DIR/ConvenientTelemetry.tsv
+
+# GNU time gives the peak memory of the stage
+if [ -x /usr/bin/time ] && /usr/bin/time -f "%M" true 2> /dev/null;
+then
+	telemetry_gnu_time=1
+else
+	telemetry_gnu_time=0
+fi
+
+# Add a line to a telemetry file, writing its header first if it is new.
+# Runs (and shards) that finish at the same time write to the same files, 
+# and would interleave or lose each other's edits, so every writer of a 
+# shared file holds an flock on file.lock while it writes (as do 
+# add_to_catalog.sh and add_to_data_list.sh).
+# Format is append_telemetry file line
+append_telemetry() {
+	(
+		flock 8
+		if [ ! -s "$1" ];
+		then
+			echo "$telemetry_header" > "$1"
+		fi
+		echo "$2" >> "$1"
+	) 8> "$1.lock"
+}
+
+timed_stage() {
+	local events=${CONVENIENT_SHARD_EVENTS:-${N_EVENTS:-0}}
+	if [ "$1" == "-n" ];
+	then
+		events=$2
+		shift 2
+	fi
+	local stage=$1
+	shift
+
+	if [ -z "$CONVENIENT_TELEMETRY_FILE" ];
+	then
+		"$@"
+		return $?
+	fi
+
+	# The measurements of the stage are left in these files by the subshell
+	# that runs it. Its CPU time and bytes include those of every process it
+	# started, since they are added to it as each one exits.
+	local record=$(mktemp)
+	local start=$(date +%s.%N)
+	(
+		if [ $telemetry_gnu_time -eq 1 ] && [ "$(type -t $1)" == "file" ];
+		then
+			/usr/bin/time -f "%M" -o $record.rss "$@"
+		else
+			"$@"
+		fi
+		status=$?
+		times > $record.times
+		cat /proc/$BASHPID/io > $record.io 2> /dev/null
+		exit $status
+	)
+	local status=$?
+	local end=$(date +%s.%N)
+
+	# The CPU time is the second line of times, that of the processes the
+	# subshell started, e.g. "1m2.500s 0m0.250s"
+	local cpu=$(tail -n 1 $record.times | awk '{
+		split($1, u, /[ms]/); split($2, s, /[ms]/);
+		printf "%.2f", 60 * u[1] + u[2] + 60 * s[1] + s[2]}')
+	local rss=$(tail -n 1 $record.rss 2> /dev/null)
+	local read_bytes=$(awk '/^rchar:/ {print $2}' $record.io 2> /dev/null)
+	local written_bytes=$(awk '/^wchar:/ {print $2}' $record.io 2> /dev/null)
+	rm -f $record $record.rss $record.times $record.io
+
+	local line=$(echo "$start $end $events" | awk -v OFS='\t' \
+		-v context="$CONVENIENT_TELEMETRY_CONTEXT" -v host=$(hostname) \
+		-v stage=$stage -v status=$status -v cpu=$cpu -v rss=${rss:-NA} \
+		-v bytes_in=${read_bytes:-NA} -v bytes_out=${written_bytes:-NA} '{
+		wall = $2 - $1
+		rate = (wall > 0) ? sprintf("%.1f", $3 / wall) : "NA"
+		print context, host, stage, $3, status, sprintf("%.2f", wall), \
+			cpu, rss, bytes_in, bytes_out, rate}')
+	append_telemetry "$CONVENIENT_TELEMETRY_FILE" "$line"
+	append_telemetry "$telemetry_log" "$line"
+	return $status
+}
@@ -0,0 +1,76 @@
+# Author: Colin Weber (webe1077@umn.edu)
+# Date: 16 October 2026
+# Purpose: To make sure the beam energy files of every generator exist and
+# are up to date for a flux histogram. They are all written at once by
+# make_generator_fluxes.C, and cached in the beam_energies directory of each
+# generator. The MD5 checksum of the flux file they were made from is kept
+# in exports/, so a flux that has already been exported is skipped, and a
+# flux file that has been changed is exported again.
+
+# Command: bash export_flux.sh -f flux_file -h flux_histo
+
+# Parameters
+#	-f
+#		The path to the ROOT file containing the neutrino flux as a 1D
+#		histogram
+#	-h
+#		The name of the neutrino flux in flux_file
+
+# Outputs
+#	$CONVENIENT_DIR/NEUT/beam_energies/<flux file>.<flux histo>.txt
+#	$CONVENIENT_DIR/NEUT/beam_energies/<flux file>.<flux histo>.root
+#	$CONVENIENT_DIR/GiBUU/beam_energies/<flux file>.<flux histo>.dat
+#	$CONVENIENT_DIR/NuWro/beam_energies/<flux file>.<flux histo>.txt
+#		The flux in the format of each generator (see
+#		make_generator_fluxes.C), where <flux file> is the path of the flux
+#		file relative to $CONVENIENT_DIR with every / changed to _
+#	$CONVENIENT_DIR/flux/exports/<flux file>.<flux histo>.md5
+#		The checksum of the flux file the outputs were made from
+
+# She-bang!
+#!/bin/bash
+
+flux_file=$2
+flux_histo=$4
+
+# Construct the name shared by all the outputs
+flux_filename_tmp=${flux_file/$CONVENIENT_DIR\//}
+flux_filename=${flux_filename_tmp//[\/]/_}.$flux_histo
+
+neut_txt="$CONVENIENT_DIR/NEUT/beam_energies/$flux_filename.txt"
+neut_root="$CONVENIENT_DIR/NEUT/beam_energies/$flux_filename.root"
+gibuu_dat="$CONVENIENT_DIR/GiBUU/beam_energies/$flux_filename.dat"
+nuwro_txt="$CONVENIENT_DIR/NuWro/beam_energies/$flux_filename.txt"
+checksum_file="$CONVENIENT_DIR/flux/exports/$flux_filename.md5"
+
+mkdir -p "$CONVENIENT_DIR/flux/exports"
+
+# Runs going at once share the outputs, so hold a lock while checking and
+# creating them
+exec 9> "$CONVENIENT_DIR/flux/exports/.lock"
+flock 9
+
+checksum=$(md5sum < "$flux_file" | cut -d ' ' -f 1)
+
+# Skip the export if every output exists and was made from this flux file
+if [ -f "$checksum_file" ] && [ "$(<"$checksum_file")" == "$checksum" ] && \
+	[ -f "$neut_txt" ] && [ -f "$neut_root" ] && [ -f "$gibuu_dat" ] && \
+	[ -f "$nuwro_txt" ];
+then
+	exit 0
+fi
+
+# Remove the old checksum first, so that an export that doesn't finish is
+# tried again next time
+rm -f "$checksum_file"
+mkdir -p "$CONVENIENT_DIR/NEUT/beam_energies" \
+	"$CONVENIENT_DIR/GiBUU/beam_energies" "$CONVENIENT_DIR/NuWro/beam_energies"
+root -q "$CONVENIENT_DIR/flux/make_generator_fluxes.C(\"$flux_file\", \"$flux_histo\", \"$neut_txt\", \"$neut_root\", \"$gibuu_dat\", \"$nuwro_txt\")"
+
+if [ ! -f "$neut_txt" ] || [ ! -f "$neut_root" ] || [ ! -f "$gibuu_dat" ] || \
+	[ ! -f "$nuwro_txt" ];
+then
+	echo "Could not export $flux_histo from $flux_file." >&2
+	exit 1
+fi
+echo "$checksum" > "$checksum_file"
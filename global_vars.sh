@@ -18,6 +18,9 @@
 #	CONVENIENT_NUISANCE_DIR
 #		The path to the directory that contains all the scripts that run 
 #		NUISANCE.
+#	CONVENIENT_BIN_DIR
+#		The path to the directory that contains the compiled CONVENIENT 
+#		tools, built by BuildGenerators/build_convenient_tools_gpvm.sh.
 #	CONVENIENT_NOvA_OUTPUT_DIR
 #		The path to the directory where all of the CONVENIENT files made 
 #		with the NOvA target are stored.
@@ -30,6 +33,9 @@
 #	CONVENIENT_NUISANCE_OUTPUT_DIR
 #		The path to the directory where all of the NUISANCE files made with 
 #		a single element are stored.
+#	CONVENIENT_WORK_DIR
+#		The path to the directory in which run.sh gives each run its own 
+#		working directory, and keeps the logs of the runs.
 
 # Sources
 #	/grid/fermiapp/products/larsoft/setups (optional)
@@ -45,11 +51,13 @@ export CONVENIENT_GEN_BUILD_DIR=$CONVENIENT_DIR/BuildGenerators
 export CONVENIENT_FLUX_DIR=$CONVENIENT_DIR/flux
 export CONVENIENT_TAR_DIR=$CONVENIENT_DIR/targets
 export CONVENIENT_NUISANCE_DIR=$CONVENIENT_DIR/NUISANCE
+export CONVENIENT_BIN_DIR=$CONVENIENT_DIR/build/bin
 
 export CONVENIENT_NOvA_OUTPUT_DIR=$OUTPUT_DIR/ConvenientOutputs_NOvA
 export CONVENIENT_NUISANCE_NOvA_OUTPUT_DIR=$OUTPUT_DIR/NUISANCEOutputs_NOvA
 export CONVENIENT_OUTPUT_DIR=$OUTPUT_DIR/ConvenientOutputs
 export CONVENIENT_NUISANCE_OUTPUT_DIR=$OUTPUT_DIR/NUISANCEOutputs
+export CONVENIENT_WORK_DIR=$OUTPUT_DIR/ConvenientWork
 
 # Dependencies
 # Set up the UPS products needed to build and use Convenient
@@ -0,0 +1,852 @@
+// Author: Colin Weber (webe1077@umn.edu)
+// Date: 16 October 2026
+// Purpose: To fill the histograms of a cross section analysis from many
+// CONVENIENT files (of many generators and tunes) at once, on all the cores
+// of the machine, instead of one file after the other on a single core.
+//
+// The files are cut into chunks of consecutive entries, and a pool of
+// threads takes chunks from a shared queue until none are left, so a
+// thread that finishes a small file moves straight on to the next chunk of
+// a large one. Every chunk fills its own copy of the histograms. When all
+// chunks are done, the copies of each file are added together in chunk
+// order, so the result does not depend on the number of threads or on
+// which thread happened to process which chunk.
+//
+// Command: #include "convenient_analysis.h"
+// Typical use, with file_list as returned by set_file_list_scales in
+// xsec_analysis_macro.C:
+// 	convenient::AnalysisEngine engine;
+// 	engine.AddFiles(file_list);
+// 	engine.Run(
+// 		[]() {
+// 			return convenient::HistogramSet{
+// 				new TH1D("h_Enu", "Enu", 40, 0, 10)};
+// 		},
+// 		[](convenient::Reader& reader, convenient::HistogramSet& h) {
+// 			if(reader.PDGnu() != 14 || !reader.flagCC()) return;
+// 			h[0]->Fill(reader.Enu(), reader.Weight());
+// 		});
+// 	convenient::HistogramSet genie = engine.GeneratorResult("GENIE");
+// The fill function is called from several threads at once, so it must
+// only touch the reader and histograms it is given (and constants).
+//
+// Instead of writing the book and fill functions by hand, an analysis can
+// declare its selection, observables, and histograms with
+// convenient::Analysis (below), which writes them for it.
+//
+// The histograms of each file can also be kept in a cache directory (see
+// SetCache), before the file scale is applied. When the analysis is run
+// again, a file whose histograms are in the cache is not read at all, so
+// adding one more seed to a comparison only reads the new file, and
+// rerunning to restyle the plots reads none.
+
+#ifndef CONVENIENT_ANALYSIS_H
+#define CONVENIENT_ANALYSIS_H
+
+// Includes
+// ROOT includes
+#include "TROOT.h" // For ROOT::EnableThreadSafety
+#include "TFile.h"
+#include "TTree.h"
+#include "TH1.h"
+#include "TH2.h"
+#include "TH3.h"
+#include "TMD5.h" // For the keys of the cache
+#include "TNamed.h"
+#include "TSystem.h" // For creating the cache directory
+
+// CONVENIENT includes
+#include "convenient_bootstrap.h" // For the MC statistical covariances
+#include "convenient_format.h" // For reading the files
+#include "convenient_flux.h" // For integrating the fluxes
+#include "convenient_subsample.h" // For quick looks at subsamples
+
+// C++ includes
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <sstream> // For describing the analysis to the cache
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace convenient {
+
+// The histograms filled by one analysis. Since all ROOT histogram classes
+// derive from TH1, 1D, 2D, and 3D histograms can be mixed.
+typedef std::vector<TH1*> HistogramSet;
+
+// The number of entries in one chunk of work. Small enough that the
+// chunks of a few files keep many cores busy, and large enough that
+// opening a reader for each chunk costs nothing in comparison.
+const Long64_t kDefaultChunkSize = 100000;
+
+// One input file of an analysis
+struct AnalysisFile {
+	// The name under which files are combined, usually the generator
+	// ('GENIE', 'NuWro', 'NEUT', or 'GiBUU') or the tune
+	std::string generator;
+	std::string filename;
+	// The factor applied to the histograms of this file when combining
+	// files, e.g. 1 / the number of files of the generator
+	double file_scale;
+};
+
+class AnalysisEngine {
+ public:
+	// Creates the histograms of the analysis, empty
+	typedef std::function<HistogramSet()> BookFunction;
+	// Fills the histograms with the current entry of the reader
+	typedef std::function<void(Reader&, HistogramSet&)> FillFunction;
+
+	// n_threads = 0 uses one thread per core
+	explicit AnalysisEngine(unsigned n_threads = 0, \
+		Long64_t chunk_size = kDefaultChunkSize) : \
+		fNThreads(n_threads), fChunkSize(chunk_size) {
+		if(fNThreads == 0) fNThreads = std::thread::hardware_concurrency();
+		if(fNThreads == 0) fNThreads = 1;
+		if(fChunkSize < 1) fChunkSize = kDefaultChunkSize;
+	}
+
+	// Skip, using the selection index of each file, the entries that can't 
+	// pass the analysis, e.g. [](const convenient::IndexEntry& e) { return 
+	// e.PDGnu == 14 && e.flagCC(); }. The fill function then only sees the 
+	// entries that pass. Files without an index are read in full.
+	void SetIndexSelection(IndexSelection selection) {
+		fIndexSelection = selection;
+	}
+
+	// Keep the histograms of each file in cache_dir, and reuse them
+	// instead of reading the file when the same file is analyzed with the
+	// same definition again. The definition describes the book and fill
+	// functions (and the index selection), e.g. "numuCC_1pi v3", and must
+	// change whenever they do, since the engine can't tell when they have.
+	// A file is recognized by its ROOT UUID, modification date, and size,
+	// which are read from the file without reading its events, so a file
+	// that has been regenerated or updated (e.g. reweighted) is read
+	// again. An empty cache_dir turns the cache off.
+	void SetCache(const std::string& cache_dir, \
+		const std::string& definition) {
+		fCacheDir = cache_dir;
+		fCacheDefinition = definition;
+	}
+
+	// Read only a stratified subsample of each file, with about fraction 
+	// of its events, each weighted by 1 / the probability it was kept so 
+	// that the histograms stay unbiased (see convenient_subsample.h). The 
+	// subsample is combined with the index selection, and is picked for 
+	// all the files at once, one file per thread. For quick looks; a 
+	// fraction of 1 reads everything again.
+	void SetSubsample(double fraction, uint64_t seed = 0, \
+		Long64_t min_per_stratum = kDefaultMinPerStratum) {
+		fSubsample = StratifiedSubsample(fraction, seed, min_per_stratum);
+	}
+
+	~AnalysisEngine() { Clear(); }
+
+	// A composite file (see convenient_format.h) is replaced by its 
+	// element files, each with file_scale times its weight, so the 
+	// histograms of the generator are those of the composite target
+	void AddFile(const std::string& generator, const std::string& filename, \
+		double file_scale = 1) {
+		std::unique_ptr<TFile> file(TFile::Open(filename.c_str()));
+		if(file && !file->IsZombie()) {
+			AddFile(generator, file.get(), file_scale);
+			return;
+		}
+		fFiles.push_back({generator, filename, file_scale});
+	}
+
+	// Each thread opens its own copy of the file, so only the name of an
+	// already open file is used
+	void AddFile(const std::string& generator, TFile* file, \
+		double file_scale = 1) {
+		std::vector<CompositeElement> elements = ReadComposite(file);
+		if(elements.empty()) {
+			fFiles.push_back({generator, std::string(file->GetName()), \
+				file_scale});
+			return;
+		}
+		for(const CompositeElement& element : elements) {
+			fFiles.push_back({generator, element.filename, \
+				file_scale * element.weight});
+		}
+	}
+
+	// Adds all the files of a list in the (generator, file, file scale)
+	// format of set_file_list_scales in xsec_analysis_macro.C
+	template <typename String>
+	void AddFiles(const std::vector<std::tuple<String, TFile*, double>>& \
+		file_list) {
+		for(const auto& entry : file_list) {
+			AddFile(std::get<0>(entry), std::get<1>(entry), \
+				std::get<2>(entry));
+		}
+	}
+
+	// Fills the histograms from every entry of every file. After this, the
+	// histograms of each file are available through FileResult, and those
+	// of each generator through GeneratorResult.
+	void Run(BookFunction book, FillFunction fill) {
+		ClearResults();
+		ROOT::EnableThreadSafety();
+		bool add_directory = TH1::AddDirectoryStatus();
+		TH1::AddDirectory(kFALSE);
+
+		// Cut the files into chunks, and keep the flux of each file. With an 
+		// index selection, the chunks are cut from the list of selected 
+		// entries of each file instead of from all its entries. The files 
+		// whose histograms are in the cache are not cut at all.
+		HistogramSet prototype = book();
+		std::vector<Chunk> chunks;
+		std::vector<std::vector<Long64_t>> selected(fFiles.size());
+		std::vector<std::vector<double>> scales(fFiles.size());
+		std::vector<std::string> cache_files(fFiles.size());
+		std::vector<HistogramSet> cached(fFiles.size());
+		// The files to be read, and how many of their entries
+		std::vector<size_t> to_read;
+		std::vector<const std::vector<Long64_t>*> file_entries(fFiles.size(), \
+			nullptr);
+		std::vector<Long64_t> file_n_entries(fFiles.size(), 0);
+		if(!fCacheDir.empty()) gSystem->mkdir(fCacheDir.c_str(), kTRUE);
+		for(size_t f = 0; f < fFiles.size(); f++) {
+			std::unique_ptr<TFile> file(TFile::Open(fFiles[f].filename.c_str()));
+			TTree* tree = file ? (TTree*) file->Get(kTreeName) : nullptr;
+			if(!tree) {
+				std::cout << "Could not read " << kTreeName << " from " << \
+					fFiles[f].filename << "!  Skipping it.\n";
+				fFluxes.push_back(nullptr);
+				continue;
+			}
+			TH1D* flux = (TH1D*) file->Get(kFluxName);
+			if(flux) {
+				flux = (TH1D*) flux->Clone();
+				flux->SetDirectory(nullptr);
+			}
+			fFluxes.push_back(flux);
+			Long64_t n_entries = tree->GetEntries();
+			if(!fCacheDir.empty()) {
+				cache_files[f] = CacheFile(file.get(), n_entries);
+				cached[f] = ReadCache(cache_files[f], prototype);
+				if(!cached[f].empty()) {
+					std::cout << fFiles[f].filename << ": using the " << \
+						"histograms in " << cache_files[f] << ".\n";
+					continue;
+				}
+			}
+			if(fIndexSelection) {
+				if(SelectEntries(file.get(), fIndexSelection, selected[f])) {
+					std::cout << fFiles[f].filename << ": " << \
+						selected[f].size() << " of " << n_entries << \
+						" entries pass the index selection.\n";
+					file_entries[f] = &selected[f];
+					n_entries = selected[f].size();
+				}
+				else {
+					std::cout << fFiles[f].filename << " has no selection " << \
+						"index.  Reading all its entries.\n";
+				}
+			}
+			to_read.push_back(f);
+			file_n_entries[f] = n_entries;
+		}
+
+		// Pick the subsample of every file to be read. This reads a few 
+		// branches of every entry, so the files are done in parallel, one 
+		// per thread at a time, like the chunks below.
+		if(fSubsample.Active()) {
+			std::vector<std::string> reports(fFiles.size());
+			std::atomic<size_t> next_file(0);
+			std::exception_ptr error;
+			std::atomic<bool> failed(false);
+			auto work = [&]() {
+				for(size_t i = next_file++; i < to_read.size(); i = next_file++) {
+					if(failed) return;
+					size_t f = to_read[i];
+					try {
+						std::unique_ptr<TFile> file(TFile::Open(\
+							fFiles[f].filename.c_str()));
+						StratifiedSubsample subsample = fSubsample;
+						subsample.Select(file.get());
+						std::ostringstream report;
+						report << fFiles[f].filename << ": ";
+						subsample.Print(report);
+						reports[f] = report.str();
+						// Keep the subsampled entries that pass the index 
+						// selection
+						const std::vector<Long64_t>* entries = file_entries[f];
+						std::vector<Long64_t> kept;
+						const std::vector<Long64_t>& sub = subsample.Entries();
+						for(size_t k = 0, j = 0; k < sub.size(); k++) {
+							if(entries) {
+								while(j < entries->size() && \
+									(*entries)[j] < sub[k]) j++;
+								if(j == entries->size() || \
+									(*entries)[j] != sub[k]) continue;
+							}
+							kept.push_back(sub[k]);
+							scales[f].push_back(subsample.Scales()[k]);
+						}
+						selected[f] = kept;
+						file_entries[f] = &selected[f];
+						file_n_entries[f] = selected[f].size();
+					}
+					catch(...) {
+						if(!failed.exchange(true)) {
+							error = std::current_exception();
+						}
+						return;
+					}
+				}
+			};
+			unsigned n_threads = std::min<size_t>(fNThreads, \
+				std::max<size_t>(to_read.size(), 1));
+			std::vector<std::thread> threads;
+			for(unsigned t = 1; t < n_threads; t++) threads.emplace_back(work);
+			work();
+			for(std::thread& thread : threads) thread.join();
+			if(error) {
+				for(TH1* h : prototype) delete h;
+				TH1::AddDirectory(add_directory);
+				std::rethrow_exception(error);
+			}
+			for(size_t f : to_read) std::cout << reports[f];
+		}
+
+		for(size_t f : to_read) {
+			const std::vector<double>* entry_scales = \
+				fSubsample.Active() ? &scales[f] : nullptr;
+			for(Long64_t begin = 0; begin < file_n_entries[f]; \
+				begin += fChunkSize) {
+				chunks.push_back({f, begin, \
+					std::min(begin + fChunkSize, file_n_entries[f]), \
+					file_entries[f], entry_scales, HistogramSet()});
+			}
+		}
+
+		// Give every chunk, and every file, its own copy of the histograms.
+		// Cloning is done here rather than in the threads so that the
+		// threads never create ROOT objects.
+		for(Chunk& chunk : chunks) chunk.histograms = CloneSet(prototype);
+		for(size_t f = 0; f < fFiles.size(); f++) {
+			fResults.push_back(cached[f].empty() ? CloneSet(prototype) : \
+				cached[f]);
+		}
+		for(TH1* h : prototype) delete h;
+
+		// Let every thread take the next unprocessed chunk until none are
+		// left
+		std::atomic<size_t> next_chunk(0);
+		std::exception_ptr error;
+		std::atomic<bool> failed(false);
+		auto work = [&]() {
+			std::unique_ptr<TFile> file;
+			size_t open_file = fFiles.size();
+			for(size_t c = next_chunk++; c < chunks.size(); c = next_chunk++) {
+				if(failed) return;
+				Chunk& chunk = chunks[c];
+				try {
+					if(chunk.file != open_file) {
+						file.reset(TFile::Open(\
+							fFiles[chunk.file].filename.c_str()));
+						open_file = chunk.file;
+					}
+					Reader reader(file.get());
+					if(chunk.entries) {
+						for(Long64_t i = chunk.begin; i < chunk.end; i++) {
+							if(!reader.SetEntry((*chunk.entries)[i])) continue;
+							if(chunk.scales) {
+								reader.SetEntryScale((*chunk.scales)[i]);
+							}
+							fill(reader, chunk.histograms);
+						}
+						continue;
+					}
+					reader.SetEntriesRange(chunk.begin, chunk.end);
+					while(reader.Next()) fill(reader, chunk.histograms);
+				}
+				catch(...) {
+					if(!failed.exchange(true)) error = std::current_exception();
+					return;
+				}
+			}
+		};
+		unsigned n_threads = std::min<size_t>(fNThreads, \
+			std::max<size_t>(chunks.size(), 1));
+		std::vector<std::thread> threads;
+		for(unsigned t = 1; t < n_threads; t++) threads.emplace_back(work);
+		work();
+		for(std::thread& thread : threads) thread.join();
+
+		// Add the chunks of each file together, always in the same order
+		for(Chunk& chunk : chunks) {
+			for(size_t h = 0; h < chunk.histograms.size(); h++) {
+				fResults[chunk.file][h]->Add(chunk.histograms[h]);
+				delete chunk.histograms[h];
+			}
+		}
+
+		// Keep the histograms of the files that were read for next time
+		if(!error) {
+			for(size_t f = 0; f < fFiles.size(); f++) {
+				if(cache_files[f].empty() || !cached[f].empty()) continue;
+				WriteCache(cache_files[f], fResults[f]);
+			}
+		}
+
+		TH1::AddDirectory(add_directory);
+		if(error) std::rethrow_exception(error);
+	}
+
+	size_t NFiles() const { return fFiles.size(); }
+	const AnalysisFile& File(size_t i) const { return fFiles[i]; }
+
+	// The histograms of file i, without the file scale. Owned by the
+	// engine.
+	const HistogramSet& FileResult(size_t i) const { return fResults[i]; }
+
+	// The flux of file i, or nullptr if it has none. Owned by the engine.
+	TH1D* FileFlux(size_t i) const { return fFluxes[i]; }
+
+	// The generators, in the order their first file was added
+	std::vector<std::string> Generators() const {
+		std::vector<std::string> generators;
+		for(const AnalysisFile& file : fFiles) {
+			if(std::find(generators.begin(), generators.end(), \
+				file.generator) == generators.end()) {
+				generators.push_back(file.generator);
+			}
+		}
+		return generators;
+	}
+
+	// The sum over the files of a generator of their histograms times
+	// their file scale. The caller owns the returned histograms.
+	HistogramSet GeneratorResult(const std::string& generator) const {
+		HistogramSet result;
+		for(size_t f = 0; f < fFiles.size(); f++) {
+			if(fFiles[f].generator != generator) continue;
+			if(result.empty()) {
+				result = CloneSet(fResults[f]);
+				for(TH1* h : result) h->Scale(fFiles[f].file_scale);
+				continue;
+			}
+			for(size_t h = 0; h < result.size(); h++) {
+				result[h]->Add(fResults[f][h], fFiles[f].file_scale);
+			}
+		}
+		return result;
+	}
+
+	// The flux of the first file of a generator. All the files of a
+	// generator are expected to have been made with the same flux. Owned by
+	// the engine.
+	TH1D* Flux(const std::string& generator) const {
+		for(size_t f = 0; f < fFiles.size(); f++) {
+			if(fFiles[f].generator == generator) return fFluxes[f];
+		}
+		return nullptr;
+	}
+
+	// The table for integrating the flux of a generator (see
+	// convenient_flux.h), or nullptr if it has no flux. Generators with
+	// the same flux share one table.
+	std::shared_ptr<const FluxTable> GeneratorFluxTable( \
+		const std::string& generator) const {
+		return FluxTable::Shared(Flux(generator));
+	}
+
+	// Forgets all files and results
+	void Clear() {
+		ClearResults();
+		fFiles.clear();
+	}
+
+ private:
+	// A range of consecutive entries of one file, and the histograms
+	// filled from it. If entries is set, the range is of positions in that 
+	// list of selected entries rather than of entries of the file. If 
+	// scales is set too, the weight of each of those entries is multiplied 
+	// by its scale.
+	struct Chunk {
+		size_t file;
+		Long64_t begin;
+		Long64_t end;
+		const std::vector<Long64_t>* entries;
+		const std::vector<double>* scales;
+		HistogramSet histograms;
+	};
+
+	unsigned fNThreads;
+	Long64_t fChunkSize;
+	std::vector<AnalysisFile> fFiles;
+	std::vector<HistogramSet> fResults;
+	std::vector<TH1D*> fFluxes;
+	IndexSelection fIndexSelection;
+	StratifiedSubsample fSubsample;
+	std::string fCacheDir;
+	std::string fCacheDefinition;
+
+	static std::string MD5(const std::string& text) {
+		TMD5 md5;
+		md5.Update((const UChar_t*) text.data(), text.size());
+		md5.Final();
+		return md5.AsString();
+	}
+
+	// The cache file of a file, named after the fingerprint of the file
+	// and the definition of the analysis
+	std::string CacheFile(TFile* file, Long64_t n_entries) const {
+		std::string fingerprint = std::string(file->GetUUID().AsString()) + \
+			" " + file->GetModificationDate().AsSQLString() + " " + \
+			std::to_string(file->GetSize()) + " " + \
+			std::to_string(n_entries);
+		return fCacheDir + "/" + MD5(fingerprint) + "_" + \
+			MD5(fCacheDefinition + fSubsample.Definition()) + ".root";
+	}
+
+	// The histograms in a cache file, or none if there is no cache file or
+	// it doesn't match the booked histograms. The caller owns them.
+	static HistogramSet ReadCache(const std::string& cache_file, \
+		const HistogramSet& prototype) {
+		HistogramSet histograms;
+		if(gSystem->AccessPathName(cache_file.c_str())) return histograms;
+		std::unique_ptr<TFile> file(TFile::Open(cache_file.c_str()));
+		if(!file || file->IsZombie()) return histograms;
+		for(size_t h = 0; h < prototype.size(); h++) {
+			TH1* cached = (TH1*) file->Get(("partial_" + \
+				std::to_string(h)).c_str());
+			if(!cached || \
+				cached->GetNcells() != prototype[h]->GetNcells()) {
+				for(TH1* c : histograms) delete c;
+				histograms.clear();
+				return histograms;
+			}
+			cached->SetDirectory(nullptr);
+			histograms.push_back(cached);
+		}
+		return histograms;
+	}
+
+	// Writes the histograms of a file, with their sums of weights and of
+	// squared weights, to its cache file. The file is written under a
+	// temporary name first, so that an analysis running at the same time
+	// never reads half of it.
+	void WriteCache(const std::string& cache_file, \
+		const HistogramSet& histograms) const {
+		std::string temporary = cache_file + "." + \
+			std::to_string(gSystem->GetPid()) + ".tmp";
+		std::unique_ptr<TFile> file(TFile::Open(temporary.c_str(), \
+			"RECREATE"));
+		if(!file || file->IsZombie()) {
+			std::cout << "Could not write " << cache_file << ".\n";
+			return;
+		}
+		for(size_t h = 0; h < histograms.size(); h++) {
+			if(histograms[h]->GetSumw2N() == 0) histograms[h]->Sumw2();
+			histograms[h]->Write(("partial_" + std::to_string(h)).c_str());
+		}
+		TNamed("definition", fCacheDefinition.c_str()).Write();
+		file->Close();
+		gSystem->Rename(temporary.c_str(), cache_file.c_str());
+	}
+
+	static HistogramSet CloneSet(const HistogramSet& set) {
+		HistogramSet clones;
+		for(TH1* h : set) {
+			TH1* clone = (TH1*) h->Clone();
+			clone->SetDirectory(nullptr);
+			clones.push_back(clone);
+		}
+		return clones;
+	}
+
+	void ClearResults() {
+		for(HistogramSet& set : fResults) {
+			for(TH1* h : set) delete h;
+		}
+		fResults.clear();
+		for(TH1D* flux : fFluxes) delete flux;
+		fFluxes.clear();
+	}
+};
+
+// A quantity computed from the current entry of a reader, e.g. the 
+// neutrino energy or the angle of the leading pion
+typedef std::function<double(Reader&)> Observable;
+// Whether the current entry of a reader passes a selection
+typedef std::function<bool(Reader&)> Selection;
+
+// The most observables one Analysis can define. Their values for the 
+// current event are kept on the stack, so the event loop does not allocate.
+const int kMaxObservables = 32;
+
+// An analysis declared up front: a selection, the observables, and the 
+// histograms of those observables, with their binning. Running it fills 
+// every booked histogram in a single pass over each file, however many 
+// cross sections are being extracted, and computes each observable at 
+// most once per selected event. Typical use:
+// 	convenient::Analysis analysis;
+// 	analysis.SetSelection([](convenient::Reader& r) {
+// 		return r.PDGnu() == 14 && r.flagCC(); });
+// 	analysis.Define("Enu", [](convenient::Reader& r) { return r.Enu(); });
+// 	analysis.Define("PiTheta", ...);
+// 	int h_Enu = analysis.Book("h_Enu", "E_{#nu}", "Enu", Enu_binning);
+// 	int h_2D = analysis.Book("h_2D", "E_{#nu} vs #theta_{#pi}",
+// 		"Enu", Enu_binning, "PiTheta", PiTheta_binning);
+// 	analysis.Run(engine);
+// 	TH1* genie_Enu = engine.GeneratorResult("GENIE")[h_Enu];
+// As with AnalysisEngine, the functions are called from several threads at 
+// once, so they must only use the reader they are given.
+//
+// With SetBootstrap, the same pass also fills Poisson bootstrap replicas of 
+// every booked histogram (see convenient_bootstrap.h), from which 
+// BootstrapCovariance gives the MC statistical covariance of each cross 
+// section, instead of rerunning the analysis once per replica.
+class Analysis {
+ public:
+	// The selection every event must pass before any histogram is filled
+	void SetSelection(Selection selection) { fSelection = selection; }
+
+	// The weight each event is filled with. Defaults to reader.Weight(), 
+	// the generator scale factor times the event weight.
+	void SetWeight(Observable weight) { fWeight = weight; }
+
+	// A looser version of the selection that can be decided from the 
+	// selection index alone, so that the entries that fail it are never 
+	// read. See AnalysisEngine::SetIndexSelection. The selection is still 
+	// applied to the entries that pass.
+	void SetIndexSelection(IndexSelection selection) {
+		fIndexSelection = selection;
+	}
+
+	// Keep the histograms of each file in cache_dir (see 
+	// AnalysisEngine::SetCache). The booked histograms and their binning 
+	// are part of the definition automatically, but the code of the 
+	// selection, index selection, weight, and observables is not, so 
+	// version must change whenever that code does, e.g. by including the 
+	// checksum of the macro that defines them (see xsec_analysis_macro.C).
+	void SetCache(const std::string& cache_dir, const std::string& version) {
+		fCacheDir = cache_dir;
+		fCacheVersion = version;
+	}
+
+	// Fill n_replicas Poisson bootstrap replicas of every booked histogram 
+	// alongside it, with weights drawn from seed. The replicas of the 
+	// histogram with index h are at ReplicaIndex(h) in the HistogramSets of 
+	// the AnalysisEngine. 0 replicas turns the bootstrap off.
+	void SetBootstrap(int n_replicas, uint64_t seed = 0) {
+		if(n_replicas > kMaxBootstrapReplicas) {
+			std::cout << "Cannot fill more than " << kMaxBootstrapReplicas << \
+				" replicas!  Filling " << kMaxBootstrapReplicas << ".\n";
+		}
+		fBootstrap = PoissonBootstrap(n_replicas, seed);
+		fBootstrapSeed = seed;
+	}
+
+	// The index of the replicas of the histogram with index h, or -1 if 
+	// the bootstrap is off. The replicas are a TH2D with the cells of the 
+	// histogram along x and the replicas along y, for BootstrapCovariance.
+	int ReplicaIndex(int h) const {
+		if(fBootstrap.NReplicas() == 0 || h < 0) return -1;
+		return fBookings.size() + h;
+	}
+
+	// Registers an observable under a name, for use in Book. Returns false 
+	// if it could not be registered.
+	bool Define(const std::string& name, Observable observable) {
+		if(FindObservable(name) >= 0) {
+			std::cout << "Observable " << name << " is already defined!\n";
+			return false;
+		}
+		if((int) fObservables.size() >= kMaxObservables) {
+			std::cout << "Cannot define more than " << kMaxObservables << \
+				" observables!  Not defining " << name << ".\n";
+			return false;
+		}
+		fObservables.push_back({name, observable});
+		return true;
+	}
+
+	// Books a 1D, 2D, or 3D histogram of observables, with the given bin 
+	// edges along each axis. An optional cut is applied to this histogram 
+	// only, on top of the selection. Returns the index of the histogram in 
+	// the HistogramSets of the AnalysisEngine, or -1 if an observable is 
+	// unknown.
+	int Book(const std::string& name, const std::string& title, \
+		const std::string& x, const std::vector<double>& x_edges, \
+		Selection cut = nullptr) {
+		return Book(name, title, {x}, {x_edges}, cut);
+	}
+	int Book(const std::string& name, const std::string& title, \
+		const std::string& x, const std::vector<double>& x_edges, \
+		const std::string& y, const std::vector<double>& y_edges, \
+		Selection cut = nullptr) {
+		return Book(name, title, {x, y}, {x_edges, y_edges}, cut);
+	}
+	int Book(const std::string& name, const std::string& title, \
+		const std::string& x, const std::vector<double>& x_edges, \
+		const std::string& y, const std::vector<double>& y_edges, \
+		const std::string& z, const std::vector<double>& z_edges, \
+		Selection cut = nullptr) {
+		return Book(name, title, {x, y, z}, {x_edges, y_edges, z_edges}, \
+			cut);
+	}
+
+	// Fills every booked histogram from every file of the engine, in one 
+	// pass over each file
+	void Run(AnalysisEngine& engine) {
+		if(fIndexSelection) engine.SetIndexSelection(fIndexSelection);
+		if(!fCacheDir.empty()) engine.SetCache(fCacheDir, Definition());
+		engine.Run([this]() { return Create(); }, \
+			[this](Reader& reader, HistogramSet& histograms) {
+				Fill(reader, histograms);
+			});
+	}
+
+ private:
+	struct NamedObservable {
+		std::string name;
+		Observable function;
+	};
+	struct Booking {
+		std::string name;
+		std::string title;
+		std::vector<int> axes; // Indices into fObservables
+		std::vector<std::vector<double>> edges;
+		Selection cut;
+	};
+
+	Selection fSelection;
+	Observable fWeight;
+	IndexSelection fIndexSelection;
+	std::vector<NamedObservable> fObservables;
+	std::vector<Booking> fBookings;
+	std::string fCacheDir;
+	std::string fCacheVersion;
+	PoissonBootstrap fBootstrap;
+	uint64_t fBootstrapSeed = 0;
+
+	// Describes the analysis for the cache: the version, and every booked 
+	// histogram with its observables, binning, and whether it has a cut
+	std::string Definition() const {
+		std::ostringstream definition;
+		definition.precision(17);
+		definition << fCacheVersion << (fWeight ? " weight" : "") << \
+			(fIndexSelection ? " index" : "");
+		if(fBootstrap.NReplicas() > 0) {
+			definition << " bootstrap " << fBootstrap.NReplicas() << " " << \
+				fBootstrapSeed;
+		}
+		for(const Booking& b : fBookings) {
+			definition << "\n" << b.name << " " << b.title << \
+				(b.cut ? " cut" : "");
+			for(size_t a = 0; a < b.axes.size(); a++) {
+				definition << " " << fObservables[b.axes[a]].name << ":";
+				for(double edge : b.edges[a]) definition << " " << edge;
+			}
+		}
+		return definition.str();
+	}
+
+	int FindObservable(const std::string& name) const {
+		for(size_t o = 0; o < fObservables.size(); o++) {
+			if(fObservables[o].name == name) return o;
+		}
+		return -1;
+	}
+
+	int Book(const std::string& name, const std::string& title, \
+		const std::vector<std::string>& axes, \
+		const std::vector<std::vector<double>>& edges, Selection cut) {
+		Booking booking = {name, title, {}, edges, cut};
+		for(const std::string& axis : axes) {
+			int o = FindObservable(axis);
+			if(o < 0) {
+				std::cout << "Observable " << axis << " is not defined!  " << \
+					"Not booking " << name << ".\n";
+				return -1;
+			}
+			booking.axes.push_back(o);
+		}
+		fBookings.push_back(booking);
+		return fBookings.size() - 1;
+	}
+
+	// Creates one empty copy of every booked histogram, followed by their 
+	// replicas if the bootstrap is on
+	HistogramSet Create() const {
+		HistogramSet histograms;
+		for(const Booking& b : fBookings) {
+			const std::vector<std::vector<double>>& e = b.edges;
+			if(b.axes.size() == 1) {
+				histograms.push_back(new TH1D(b.name.c_str(), \
+					b.title.c_str(), e[0].size() - 1, &e[0][0]));
+			}
+			else if(b.axes.size() == 2) {
+				histograms.push_back(new TH2D(b.name.c_str(), \
+					b.title.c_str(), e[0].size() - 1, &e[0][0], \
+					e[1].size() - 1, &e[1][0]));
+			}
+			else {
+				histograms.push_back(new TH3D(b.name.c_str(), \
+					b.title.c_str(), e[0].size() - 1, &e[0][0], \
+					e[1].size() - 1, &e[1][0], e[2].size() - 1, &e[2][0]));
+			}
+		}
+		if(fBootstrap.NReplicas() > 0) {
+			for(size_t h = 0; h < fBookings.size(); h++) {
+				histograms.push_back(fBootstrap.CreateReplicas(histograms[h]));
+			}
+		}
+		return histograms;
+	}
+
+	void Fill(Reader& reader, HistogramSet& histograms) const {
+		if(fSelection && !fSelection(reader)) return;
+		double weight = fWeight ? fWeight(reader) : reader.Weight();
+
+		double values[kMaxObservables];
+		for(size_t o = 0; o < fObservables.size(); o++) {
+			values[o] = fObservables[o].function(reader);
+		}
+
+		// The weights of the event in each replica, the same for every 
+		// histogram
+		int replica_weights[kMaxBootstrapReplicas];
+		if(fBootstrap.NReplicas() > 0) {
+			fBootstrap.Weights(fBootstrap.FileKey(reader.GetFile()), \
+				reader.GetCurrentEntry(), replica_weights);
+		}
+
+		for(size_t h = 0; h < fBookings.size(); h++) {
+			const Booking& b = fBookings[h];
+			if(b.cut && !b.cut(reader)) continue;
+			const std::vector<int>& a = b.axes;
+			int cell;
+			if(a.size() == 1) {
+				cell = histograms[h]->Fill(values[a[0]], weight);
+			}
+			else if(a.size() == 2) {
+				cell = ((TH2*) histograms[h])->Fill(values[a[0]], \
+					values[a[1]], weight);
+			}
+			else {
+				cell = ((TH3*) histograms[h])->Fill(values[a[0]], \
+					values[a[1]], values[a[2]], weight);
+			}
+			if(fBootstrap.NReplicas() > 0 && cell >= 0) {
+				fBootstrap.Fill(histograms[fBookings.size() + h], cell, \
+					weight, replica_weights);
+			}
+		}
+	}
+};
+
+} // namespace convenient
+
+#endif // CONVENIENT_ANALYSIS_H
@@ -0,0 +1,221 @@
+// Author: Colin Weber (webe1077@umn.edu)
+// Date: 16 October 2026
+// Purpose: To get the MC statistical uncertainty of a cross section, with
+// the correlations between its bins, from a single pass over the events.
+//
+// In a Poisson bootstrap, every event is given a random weight drawn from
+// a Poisson distribution with mean 1 in each of N replicas of the sample,
+// and each replica fills its own copy of the histograms. The spread of the
+// replicas of a cross section around each other is then its MC
+// statistical covariance. Since the weights of an event only depend on
+// the seed, the file, and the entry of the event, every replica of every
+// event is the same whichever thread or chunk it is read in, and whether
+// or not the other events are read, so the replicas are reproducible.
+//
+// The weights are drawn from a counter-based generator: the weight of
+// replica r of entry i of a file is a hash of (seed, file, i, r), turned
+// into a Poisson(1) count, so no generator state is kept or shared
+// between threads.
+//
+// The replicas of a histogram are kept in one TH2D, with the cells of
+// the histogram (including its underflow and overflow) along x and the
+// replicas along y, so that the cells of each replica are contiguous in
+// memory ([replica][cell]) and the replicas are added, scaled, and cached
+// like any other histogram.
+//
+// Command: #include "convenient_bootstrap.h"
+// Usually used through convenient::Analysis::SetBootstrap (see
+// convenient_analysis.h), which fills the replicas of every booked
+// histogram. Then, with h_index the index of a booked histogram and
+// to_xsec a function that turns a histogram into the cross section in
+// place:
+// 	convenient::HistogramSet histos = engine.GeneratorResult("GENIE");
+// 	TH2D* covariance = convenient::BootstrapCovariance("cov_GENIE",
+// 		histos[h_index], histos[analysis.ReplicaIndex(h_index)], to_xsec);
+
+#ifndef CONVENIENT_BOOTSTRAP_H
+#define CONVENIENT_BOOTSTRAP_H
+
+// Includes
+// ROOT includes
+#include "TFile.h"
+#include "TH1.h"
+#include "TH2.h"
+#include "TUUID.h" // For identifying the file of an event
+
+// C++ includes
+#include <cmath> // For std::exp
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace convenient {
+
+// The most replicas the bootstrap can fill. The weights of the replicas
+// of the current event are kept on the stack.
+const int kMaxBootstrapReplicas = 1000;
+
+// Mixes the bits of a 64-bit integer (the SplitMix64 finalizer), so that
+// counters that differ by one give unrelated outputs
+inline uint64_t MixBits(uint64_t x) {
+	x += 0x9e3779b97f4a7c15ULL;
+	x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+	return x ^ (x >> 31);
+}
+
+class PoissonBootstrap {
+ public:
+	explicit PoissonBootstrap(int n_replicas = 0, uint64_t seed = 0) : \
+		fNReplicas(n_replicas), fSeed(MixBits(seed)) {
+		if(fNReplicas < 0) fNReplicas = 0;
+		if(fNReplicas > kMaxBootstrapReplicas) {
+			fNReplicas = kMaxBootstrapReplicas;
+		}
+
+		// The cumulative probabilities of a Poisson distribution with mean
+		// 1, up to the count beyond which they are 1 in double precision
+		double probability = std::exp(-1.);
+		double cumulative = 0;
+		for(int k = 0; k < kMaxCount; k++) {
+			cumulative += probability;
+			fCumulative[k] = cumulative;
+			probability /= k + 1;
+		}
+	}
+
+	int NReplicas() const { return fNReplicas; }
+
+	// Identifies a file by its ROOT UUID, which is stored in the file and
+	// so is the same every time it is opened, by every thread
+	uint64_t FileKey(const TFile* file) const {
+		UChar_t uuid[16];
+		file->GetUUID().GetUUID(uuid);
+		uint64_t low = 0;
+		uint64_t high = 0;
+		for(int i = 0; i < 8; i++) {
+			low = (low << 8) | uuid[i];
+			high = (high << 8) | uuid[i + 8];
+		}
+		return MixBits(MixBits(fSeed ^ low) ^ high);
+	}
+
+	// The weights of every replica of an entry of the file with the given
+	// key, written to weights, which must hold NReplicas() values
+	void Weights(uint64_t file_key, Long64_t entry, int* weights) const {
+		uint64_t event_key = MixBits(file_key ^ MixBits(entry));
+		for(int r = 0; r < fNReplicas; r++) {
+			// The top 53 bits, as a uniform number in [0, 1)
+			double u = (MixBits(event_key + r) >> 11) / 9007199254740992.;
+			int k = 0;
+			while(k < kMaxCount - 1 && u >= fCumulative[k]) k++;
+			weights[r] = k;
+		}
+	}
+
+	// Creates the (empty) replicas of a histogram
+	TH2D* CreateReplicas(const TH1* nominal) const {
+		int n_cells = nominal->GetNcells();
+		TH2D* replicas = new TH2D((std::string(nominal->GetName()) + \
+			"_replicas").c_str(), nominal->GetTitle(), n_cells, 0, n_cells, \
+			fNReplicas, 0, fNReplicas);
+		replicas->SetDirectory(nullptr);
+		return replicas;
+	}
+
+	// Adds weight times the weight of each replica to a cell of the
+	// replicas, skipping the histogram machinery since the cell is
+	// already known
+	void Fill(TH1* replicas, int cell, double weight, \
+		const int* weights) const {
+		double* contents = ((TH2D*) replicas)->GetArray();
+		int stride = replicas->GetNbinsX() + 2;
+		for(int r = 0; r < fNReplicas; r++) {
+			if(weights[r] == 0) continue;
+			contents[(r + 1) * stride + cell + 1] += weight * weights[r];
+		}
+	}
+
+ private:
+	// The most events one replica can count an event as. The chance of
+	// more is below 1e-17.
+	static const int kMaxCount = 20;
+
+	int fNReplicas;
+	uint64_t fSeed;
+	double fCumulative[kMaxCount];
+};
+
+// The covariance of a cross section over the replicas of the histogram it
+// is made from. Each replica is turned into a histogram like nominal and
+// given to to_cross_section, which should do to it exactly what is done
+// to nominal to make the cross section (e.g. scale by the flux and divide
+// by the bin widths), or nothing if the cross section is the histogram
+// itself. The covariance is between the bins of nominal without the
+// underflow and overflow, numbered 1 to the number of bins in the order
+// of ROOT's global bin numbers (x fastest, then y, then z). The caller
+// owns it.
+inline TH2D* BootstrapCovariance(const char* name, const TH1* nominal, \
+	const TH1* replicas, std::function<void(TH1*)> to_cross_section = \
+	nullptr) {
+	int n_replicas = replicas->GetNbinsY();
+	int stride = replicas->GetNbinsX() + 2;
+	const double* contents = ((const TH2D*) replicas)->GetArray();
+
+	// The bins of nominal that are in range
+	std::vector<int> bins;
+	for(int cell = 0; cell < nominal->GetNcells(); cell++) {
+		if(!nominal->IsBinUnderflow(cell) && !nominal->IsBinOverflow(cell)) {
+			bins.push_back(cell);
+		}
+	}
+	size_t n_bins = bins.size();
+
+	// The cross section of each replica, as [replica][bin]
+	std::vector<double> values(n_replicas * n_bins);
+	std::unique_ptr<TH1> replica((TH1*) nominal->Clone());
+	replica->SetDirectory(nullptr);
+	for(int r = 0; r < n_replicas; r++) {
+		replica->Reset();
+		for(int cell = 0; cell < nominal->GetNcells(); cell++) {
+			replica->SetBinContent(cell, contents[(r + 1) * stride + cell + 1]);
+		}
+		if(to_cross_section) to_cross_section(replica.get());
+		for(size_t b = 0; b < n_bins; b++) {
+			values[r * n_bins + b] = replica->GetBinContent(bins[b]);
+		}
+	}
+
+	// Subtract the mean over the replicas of each bin, then sum the
+	// products of the deviations
+	std::vector<double> mean(n_bins, 0);
+	for(int r = 0; r < n_replicas; r++) {
+		for(size_t b = 0; b < n_bins; b++) mean[b] += values[r * n_bins + b];
+	}
+	for(size_t b = 0; b < n_bins; b++) mean[b] /= n_replicas;
+	for(int r = 0; r < n_replicas; r++) {
+		for(size_t b = 0; b < n_bins; b++) values[r * n_bins + b] -= mean[b];
+	}
+
+	TH2D* covariance = new TH2D(name, name, n_bins, 0.5, n_bins + 0.5, \
+		n_bins, 0.5, n_bins + 0.5);
+	covariance->SetDirectory(nullptr);
+	if(n_replicas < 2) return covariance;
+	for(size_t i = 0; i < n_bins; i++) {
+		for(size_t j = 0; j <= i; j++) {
+			double sum = 0;
+			for(int r = 0; r < n_replicas; r++) {
+				sum += values[r * n_bins + i] * values[r * n_bins + j];
+			}
+			covariance->SetBinContent(i + 1, j + 1, sum / (n_replicas - 1));
+			covariance->SetBinContent(j + 1, i + 1, sum / (n_replicas - 1));
+		}
+	}
+	return covariance;
+}
+
+} // namespace convenient
+
+#endif // CONVENIENT_BOOTSTRAP_H
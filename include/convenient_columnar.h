@@ -0,0 +1,508 @@
+// Author: Colin Weber (webe1077@umn.edu)
+// Date: 16 October 2026
+// Purpose: To define a compact columnar copy of a CONVENIENT file that can
+// be memory-mapped and scanned without any deserialization, for the scans
+// that are repeated over whole samples (rebinning studies, quick looks
+// across the catalog) and are bound by ROOT decompression rather than by
+// the disk. The ROOT file stays the primary output; the columnar file is
+// made from it by NUISANCE/make_convenient_columnar.C.
+//
+// Layout (all numbers in the native byte order, little-endian on every
+// machine CONVENIENT runs on):
+// 	ColumnarHeader
+// 	ColumnarColumn[kNColumns] : the offset and size in bytes of each column
+// 	the columns, each starting on a kColumnarAlignment byte boundary
+// The scalar columns have one value per event:
+// 	Enu (float), PDGnu (int32), target_PDG (int32), EventWeight (double),
+// 	GenScaleFactor (double), flags (uint8, bit 0 flagCC, bit 1 flagNC, as
+// 	in the selection index), int_type (int32)
+// The flux is stored as its n + 1 bin edges and n bin contents (doubles).
+// Every species has an offsets column (uint64, one per event plus one),
+// such that the particles of event i are [offsets[i], offsets[i + 1]) in
+// its E, px, py, and pz columns (floats), and, for kOthers, its pdg column
+// (int32). As in the ROOT file, the particles of a species are ordered by
+// decreasing energy. EventWeight is stored with the file-level weight
+// scale applied, as convenient::Reader::EventWeight gives it.
+//
+// Command: #include "convenient_columnar.h"
+// Typical use:
+// 	convenient::ColumnarFile file("sample.col");
+// 	convenient::Span<const float> Enu = file.Enu();
+// 	for(uint64_t i = 0; i < file.N(); i++) {
+// 		if(file.PDGnu()[i] != 14 || !(file.Flags()[i] & 1)) continue;
+// 		convenient::ParticleSpan pips = file.Particles(convenient::kPiPs, i);
+// 		if(pips.size() > 0) h->Fill(pips.E[0], file.Weight(i));
+// 	}
+// The spans point straight into the mapped file, so they are only valid
+// while the ColumnarFile exists.
+
+#ifndef CONVENIENT_COLUMNAR_H
+#define CONVENIENT_COLUMNAR_H
+
+// Includes
+// ROOT includes
+#include "TFile.h"
+#include "TH1.h"
+#include "TSystem.h" // For replacing the output once it is complete
+
+// CONVENIENT includes
+#include "convenient_format.h" // For the species and for reading the file
+
+// C++ includes
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// POSIX includes, for mapping the file
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace convenient {
+
+// Identifies a columnar CONVENIENT file, and the version of its layout
+const char kColumnarMagic[8] = {'C', 'N', 'V', 'C', 'O', 'L', 'M', 'N'};
+const uint32_t kColumnarVersion = 1;
+// Every column starts on a boundary of this many bytes, i.e. a cache line
+const uint64_t kColumnarAlignment = 64;
+
+// The columns, in the order of the column table
+enum ColumnarScalarColumn {
+	kColEnu = 0,
+	kColPDGnu,
+	kColTargetPDG,
+	kColEventWeight,
+	kColGenScaleFactor,
+	kColFlags,
+	kColIntType,
+	kColFluxEdges,
+	kColFluxContents,
+	kNScalarColumns
+};
+// The columns of each species follow the scalar columns, in this order
+enum ColumnarParticleComponent {
+	kColOffsets = 0,
+	kColE,
+	kColPx,
+	kColPy,
+	kColPz,
+	kNParticleComponents
+};
+inline int ParticleColumn(int species, int component) {
+	return kNScalarColumns + kNParticleComponents * species + component;
+}
+// The PDG codes of the other particles come last
+const int kColOthersPDG = kNScalarColumns + kNParticleComponents * kNSpecies;
+const int kNColumns = kColOthersPDG + 1;
+
+struct ColumnarHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t n_columns;
+	uint64_t n_events;
+	// The file-level weight scale of the ROOT file. It is already applied
+	// to EventWeight, and only kept for reference.
+	double weight_scale;
+	// 1 if int_type holds the GiBUU production ID (the "Mode" branch)
+	// rather than the NEUT interaction code
+	uint32_t int_type_is_mode;
+	uint32_t reserved;
+};
+
+struct ColumnarColumn {
+	uint64_t offset;
+	uint64_t size; // In bytes
+};
+
+// A read-only view of a contiguous array, e.g. a column of a mapped file
+template <typename T>
+struct Span {
+	T* data = nullptr;
+	size_t n = 0;
+
+	size_t size() const { return n; }
+	bool empty() const { return n == 0; }
+	T& operator[](size_t i) const { return data[i]; }
+	T* begin() const { return data; }
+	T* end() const { return data + n; }
+	Span<T> subspan(size_t first, size_t count) const {
+		return {data + first, count};
+	}
+};
+
+// The particles of one species in one event
+struct ParticleSpan {
+	Span<const float> E;
+	Span<const float> px;
+	Span<const float> py;
+	Span<const float> pz;
+	Span<const int32_t> pdg; // Only filled for kOthers
+
+	size_t size() const { return E.size(); }
+};
+
+// The bytes of a column held in memory at a time while it is written
+const size_t kColumnarBlockSize = 1 << 18;
+
+// One column while it is being written. The values are gathered in a block
+// in memory, and each full block is spilled to a scratch file next to the
+// output, so that only a block per column is held however large the
+// sample is. The scratch file is unlinked as soon as it is opened, so it
+// disappears when it is closed, even if the writing fails.
+class ColumnarSpool {
+ public:
+	ColumnarSpool() = default;
+	~ColumnarSpool() {
+		if(fFile) std::fclose(fFile);
+	}
+	ColumnarSpool(const ColumnarSpool&) = delete;
+	ColumnarSpool& operator=(const ColumnarSpool&) = delete;
+
+	// Where to put the scratch file, if a block has to be spilled
+	void SetScratch(const std::string& scratch) { fScratch = scratch; }
+
+	template <typename T>
+	void Append(const T& value) {
+		if(fBlock.capacity() < kColumnarBlockSize) {
+			fBlock.reserve(kColumnarBlockSize);
+		}
+		const char* bytes = (const char*) &value;
+		fBlock.insert(fBlock.end(), bytes, bytes + sizeof(T));
+		fSize += sizeof(T);
+		if(fBlock.size() >= kColumnarBlockSize) Spill();
+	}
+
+	uint64_t Size() const { return fSize; }
+	bool Ok() const { return fOk; }
+
+	// Write the whole column to out
+	bool CopyTo(FILE* out) {
+		if(!fOk) return false;
+		if(fFile) {
+			if(std::fseek(fFile, 0, SEEK_SET) != 0) return false;
+			std::vector<char> buffer(kColumnarBlockSize);
+			size_t n;
+			while((n = std::fread(buffer.data(), 1, buffer.size(), fFile)) > 0) {
+				if(std::fwrite(buffer.data(), 1, n, out) != n) return false;
+			}
+			if(std::ferror(fFile)) return false;
+		}
+		return fBlock.empty() || \
+			std::fwrite(fBlock.data(), 1, fBlock.size(), out) == fBlock.size();
+	}
+
+ private:
+	std::vector<char> fBlock;
+	std::string fScratch;
+	FILE* fFile = nullptr;
+	uint64_t fSize = 0;
+	bool fOk = true;
+
+	void Spill() {
+		if(!fFile && fOk) {
+			fFile = std::fopen(fScratch.c_str(), "w+b");
+			if(fFile) std::remove(fScratch.c_str());
+		}
+		fOk = fOk && fFile && std::fwrite(fBlock.data(), 1, fBlock.size(), \
+			fFile) == fBlock.size();
+		fBlock.clear();
+	}
+};
+
+// Write the columnar copy of the CONVENIENT file read by reader to output.
+// The columns are written in blocks (see ColumnarSpool) while the events
+// are read, then laid out one after the other in a temporary file that
+// replaces output, so a columnar file is never left half written. Returns
+// false if the file could not be written.
+inline bool WriteColumnar(Reader& reader, const std::string& output) {
+	std::string temporary = output + ".tmp" + \
+		std::to_string(gSystem->GetPid());
+	std::vector<ColumnarSpool> columns(kNColumns);
+	for(int c = 0; c < kNColumns; c++) {
+		columns[c].SetScratch(temporary + "." + std::to_string(c));
+	}
+
+	uint64_t n_events = 0;
+	uint64_t n_particles[kNSpecies] = {0};
+	for(int s = 0; s < kNSpecies; s++) {
+		columns[ParticleColumn(s, kColOffsets)].Append<uint64_t>(0);
+	}
+	while(reader.Next()) {
+		columns[kColEnu].Append<float>(reader.Enu());
+		columns[kColPDGnu].Append<int32_t>(reader.PDGnu());
+		columns[kColTargetPDG].Append<int32_t>(reader.target_PDG());
+		columns[kColEventWeight].Append<double>(reader.EventWeight());
+		columns[kColGenScaleFactor].Append<double>(reader.GenScaleFactor());
+		columns[kColFlags].Append<uint8_t>((reader.flagCC() ? 1 : 0) | \
+			(reader.flagNC() ? 2 : 0));
+		columns[kColIntType].Append<int32_t>(reader.IntType());
+		for(int s = 0; s < kNSpecies; s++) {
+			const ParticleView& particles = reader.Particles((Species) s);
+			for(int i = 0; i < particles.size(); i++) {
+				columns[ParticleColumn(s, kColE)].Append<float>(\
+					particles.E(i));
+				columns[ParticleColumn(s, kColPx)].Append<float>(\
+					particles.px(i));
+				columns[ParticleColumn(s, kColPy)].Append<float>(\
+					particles.py(i));
+				columns[ParticleColumn(s, kColPz)].Append<float>(\
+					particles.pz(i));
+				if(s == kOthers) {
+					columns[kColOthersPDG].Append<int32_t>(particles.pdg(i));
+				}
+			}
+			n_particles[s] += particles.size();
+			columns[ParticleColumn(s, kColOffsets)].Append<uint64_t>(\
+				n_particles[s]);
+		}
+		n_events++;
+	}
+
+	// The flux, as edges and contents
+	TH1D* flux = reader.Flux();
+	if(flux) {
+		int n_bins = flux->GetNbinsX();
+		for(int bin = 1; bin <= n_bins; bin++) {
+			columns[kColFluxEdges].Append<double>(\
+				flux->GetXaxis()->GetBinLowEdge(bin));
+			columns[kColFluxContents].Append<double>(\
+				flux->GetBinContent(bin));
+		}
+		columns[kColFluxEdges].Append<double>(\
+			flux->GetXaxis()->GetBinUpEdge(n_bins));
+	}
+
+	// Lay the columns out one after the other, each aligned
+	std::vector<ColumnarColumn> table(kNColumns);
+	uint64_t position = sizeof(ColumnarHeader) + \
+		kNColumns * sizeof(ColumnarColumn);
+	for(int c = 0; c < kNColumns; c++) {
+		position = (position + kColumnarAlignment - 1) / \
+			kColumnarAlignment * kColumnarAlignment;
+		table[c].offset = position;
+		table[c].size = columns[c].Size();
+		position += table[c].size;
+	}
+
+	ColumnarHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, kColumnarMagic, sizeof(kColumnarMagic));
+	header.version = kColumnarVersion;
+	header.n_columns = kNColumns;
+	header.n_events = n_events;
+	header.weight_scale = reader.WeightScale();
+	TTree* tree = (TTree*) reader.GetFile()->Get(kTreeName);
+	header.int_type_is_mode = tree && !tree->GetBranch("NEUT_int_type");
+
+	// Write everything to a temporary file, and move it into place once it
+	// is complete
+	FILE* out = std::fopen(temporary.c_str(), "wb");
+	if(!out) {
+		std::cout << "Could not create " << temporary << "!\n";
+		return false;
+	}
+	bool ok = std::fwrite(&header, sizeof(header), 1, out) == 1 && \
+		std::fwrite(table.data(), sizeof(ColumnarColumn), kNColumns, out) \
+		== (size_t) kNColumns;
+	uint64_t written = sizeof(ColumnarHeader) + \
+		kNColumns * sizeof(ColumnarColumn);
+	const char padding[kColumnarAlignment] = {0};
+	for(int c = 0; c < kNColumns && ok; c++) {
+		ok = std::fwrite(padding, 1, table[c].offset - written, out) == \
+			table[c].offset - written;
+		ok = ok && columns[c].CopyTo(out);
+		written = table[c].offset + table[c].size;
+	}
+	ok = (std::fclose(out) == 0) && ok;
+	if(!ok || gSystem->Rename(temporary.c_str(), output.c_str()) != 0) {
+		std::cout << "Could not write " << output << "!\n";
+		std::remove(temporary.c_str());
+		return false;
+	}
+	return true;
+}
+
+// A columnar CONVENIENT file, mapped into memory. The mapping is read-only
+// and shared, so every process scanning the same file uses the same pages
+// of the page cache.
+class ColumnarFile {
+ public:
+	explicit ColumnarFile(const std::string& filename) {
+		int fd = open(filename.c_str(), O_RDONLY);
+		if(fd < 0) {
+			std::cout << "Could not open " << filename << "!\n";
+			return;
+		}
+		struct stat st;
+		if(fstat(fd, &st) == 0 && st.st_size >= (off_t) (sizeof(ColumnarHeader) \
+			+ kNColumns * sizeof(ColumnarColumn))) {
+			fSize = st.st_size;
+			void* map = mmap(nullptr, fSize, PROT_READ, MAP_SHARED, fd, 0);
+			if(map != MAP_FAILED) fMap = (const char*) map;
+		}
+		// The mapping stays valid after the file is closed
+		close(fd);
+		if(!fMap) {
+			std::cout << "Could not map " << filename << "!\n";
+			return;
+		}
+		if(!Validate()) {
+			std::cout << filename << " is not a columnar CONVENIENT " << \
+				"file of version " << kColumnarVersion << "!\n";
+			munmap((void*) fMap, fSize);
+			fMap = nullptr;
+			return;
+		}
+		// The scans read the columns from start to end
+		madvise((void*) fMap, fSize, MADV_SEQUENTIAL);
+	}
+
+	~ColumnarFile() {
+		if(fMap) munmap((void*) fMap, fSize);
+	}
+
+	// The spans point into the mapping, so it can't be copied
+	ColumnarFile(const ColumnarFile&) = delete;
+	ColumnarFile& operator=(const ColumnarFile&) = delete;
+
+	bool IsOpen() const { return fMap != nullptr; }
+	uint64_t N() const { return Header().n_events; }
+	double WeightScale() const { return Header().weight_scale; }
+	bool IntTypeIsMode() const { return Header().int_type_is_mode; }
+
+	Span<const float> Enu() const { return Column<float>(kColEnu); }
+	Span<const int32_t> PDGnu() const { return Column<int32_t>(kColPDGnu); }
+	Span<const int32_t> target_PDG() const {
+		return Column<int32_t>(kColTargetPDG);
+	}
+	// Including the weight scale
+	Span<const double> EventWeight() const {
+		return Column<double>(kColEventWeight);
+	}
+	Span<const double> GenScaleFactor() const {
+		return Column<double>(kColGenScaleFactor);
+	}
+	// Bit 0: flagCC, bit 1: flagNC
+	Span<const uint8_t> Flags() const { return Column<uint8_t>(kColFlags); }
+	// NEUT_int_type, or the GiBUU Mode if IntTypeIsMode()
+	Span<const int32_t> IntType() const {
+		return Column<int32_t>(kColIntType);
+	}
+	Span<const double> FluxEdges() const {
+		return Column<double>(kColFluxEdges);
+	}
+	Span<const double> FluxContents() const {
+		return Column<double>(kColFluxContents);
+	}
+
+	// The full weight of event i, as convenient::Reader::Weight gives it
+	double Weight(uint64_t i) const {
+		return EventWeight()[i] * GenScaleFactor()[i];
+	}
+
+	// The columns of the particles of a species, over all events
+	Span<const uint64_t> Offsets(Species s) const {
+		return Column<uint64_t>(ParticleColumn(s, kColOffsets));
+	}
+	Span<const float> Component(Species s, ColumnarParticleComponent c) \
+		const {
+		return Column<float>(ParticleColumn(s, c));
+	}
+	Span<const int32_t> OthersPDG() const {
+		return Column<int32_t>(kColOthersPDG);
+	}
+
+	// The number of particles of a species in event i
+	uint64_t NParticles(Species s, uint64_t i) const {
+		Span<const uint64_t> offsets = Offsets(s);
+		return offsets[i + 1] - offsets[i];
+	}
+
+	// The particles of a species in event i
+	ParticleSpan Particles(Species s, uint64_t i) const {
+		Span<const uint64_t> offsets = Offsets(s);
+		uint64_t first = offsets[i];
+		uint64_t count = offsets[i + 1] - first;
+		ParticleSpan particles;
+		particles.E = Component(s, kColE).subspan(first, count);
+		particles.px = Component(s, kColPx).subspan(first, count);
+		particles.py = Component(s, kColPy).subspan(first, count);
+		particles.pz = Component(s, kColPz).subspan(first, count);
+		if(s == kOthers) particles.pdg = OthersPDG().subspan(first, count);
+		return particles;
+	}
+
+ private:
+	const char* fMap = nullptr;
+	uint64_t fSize = 0;
+
+	const ColumnarHeader& Header() const {
+		return *(const ColumnarHeader*) fMap;
+	}
+	const ColumnarColumn& Table(int column) const {
+		return ((const ColumnarColumn*) (fMap + sizeof(ColumnarHeader))) \
+			[column];
+	}
+
+	template <typename T>
+	Span<const T> Column(int column) const {
+		const ColumnarColumn& entry = Table(column);
+		return {(const T*) (fMap + entry.offset), entry.size / sizeof(T)};
+	}
+
+	// Check the header, and that every column lies within the file and has
+	// the size the number of events and the particle offsets imply
+	bool Validate() const {
+		const ColumnarHeader& header = Header();
+		if(std::memcmp(header.magic, kColumnarMagic, \
+			sizeof(kColumnarMagic)) != 0 || \
+			header.version != kColumnarVersion || \
+			header.n_columns != (uint32_t) kNColumns) {
+			return false;
+		}
+		for(int c = 0; c < kNColumns; c++) {
+			const ColumnarColumn& entry = Table(c);
+			if(entry.offset % kColumnarAlignment != 0 || \
+				entry.offset > fSize || entry.size > fSize - entry.offset) {
+				return false;
+			}
+		}
+		uint64_t n = header.n_events;
+		if(Enu().size() != n || PDGnu().size() != n || \
+			target_PDG().size() != n || EventWeight().size() != n || \
+			GenScaleFactor().size() != n || Flags().size() != n || \
+			IntType().size() != n) {
+			return false;
+		}
+		if(FluxEdges().size() != (FluxContents().empty() ? 0 : \
+			FluxContents().size() + 1)) {
+			return false;
+		}
+		// Particles() reads [offsets[i], offsets[i + 1]) of every component
+		// of a species, so the offsets must start at 0, never decrease, and
+		// end at the size of every component
+		for(int s = 0; s < kNSpecies; s++) {
+			Span<const uint64_t> offsets = Offsets((Species) s);
+			if(offsets.size() != n + 1 || offsets[0] != 0) return false;
+			for(uint64_t i = 0; i < n; i++) {
+				if(offsets[i + 1] < offsets[i]) return false;
+			}
+			for(int c = kColE; c <= kColPz; c++) {
+				if(Component((Species) s, (ColumnarParticleComponent) c).size() \
+					!= offsets[n]) {
+					return false;
+				}
+			}
+			if(s == kOthers && OthersPDG().size() != offsets[n]) return false;
+		}
+		return true;
+	}
+};
+
+} // namespace convenient
+
+#endif // CONVENIENT_COLUMNAR_H
@@ -0,0 +1,146 @@
+// Author: Colin Weber (webe1077@umn.edu)
+// Date: 16 October 2026
+// Purpose: To integrate a neutrino flux over any energy range, and rebin it
+// into any binning, exactly and quickly.
+//
+// A FluxTable holds the running sum of the flux up to each of its bin
+// edges, so the integral of the flux between two energies is the
+// difference of two running sums, found by a binary search of the edges.
+// The flux is taken to be flat within each of its bins, so a range that
+// ends partway through a bin gets that fraction of the bin. The signal flux
+// of a flux-averaged cross section is then the integral of the flux over
+// each analysis bin, instead of the flux bins filled at their centers (or
+// low edges), which puts a flux bin that straddles an analysis bin edge
+// wholly on one side.
+//
+// Command: #include "convenient_flux.h"
+// Typical use, with engine a convenient::AnalysisEngine that has been run
+// and h1_Enu a histogram in neutrino energy:
+// 	auto flux = engine.GeneratorFluxTable("GENIE");
+// 	double integrated_flux = flux->Integral();
+// 	double flux_1_2 = flux->Integral(1.0, 2.0);
+// 	TH1D* sig_flux = flux->Rebinned("sig_flux", h1_Enu->GetXaxis());
+//
+// Tables are shared: FluxTable::Shared returns the same table for every
+// histogram with the same edges and contents, so the generators and tunes
+// of a comparison that were made with the same flux only build it once.
+
+#ifndef CONVENIENT_FLUX_H
+#define CONVENIENT_FLUX_H
+
+// Includes
+// ROOT includes
+#include "TH1.h"
+
+// C++ includes
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace convenient {
+
+class FluxTable {
+ public:
+	// Build the table of a 1D flux histogram. The underflow and overflow
+	// are left out, as they are by TH1::Integral.
+	explicit FluxTable(const TH1* flux) {
+		int n_bins = flux->GetNbinsX();
+		fEdges.resize(n_bins + 1);
+		fCumulative.resize(n_bins + 1);
+		fEdges[0] = flux->GetXaxis()->GetBinLowEdge(1);
+		fCumulative[0] = 0;
+		for(int bin = 1; bin <= n_bins; bin++) {
+			fEdges[bin] = flux->GetXaxis()->GetBinUpEdge(bin);
+			fCumulative[bin] = fCumulative[bin - 1] + \
+				flux->GetBinContent(bin);
+		}
+	}
+
+	// The table of a flux histogram, shared with every other histogram
+	// with the same edges and contents
+	static std::shared_ptr<const FluxTable> Shared(const TH1* flux) {
+		static std::mutex mutex;
+		static std::map<std::string, std::shared_ptr<const FluxTable>> \
+			tables;
+		if(!flux) return nullptr;
+		std::string key = Key(flux);
+		std::lock_guard<std::mutex> lock(mutex);
+		std::shared_ptr<const FluxTable>& table = tables[key];
+		if(!table) table = std::make_shared<const FluxTable>(flux);
+		return table;
+	}
+
+	// The range of the flux
+	double LowEdge() const { return fEdges.front(); }
+	double UpEdge() const { return fEdges.back(); }
+
+	// The integral of the flux from its low edge up to energy
+	double Cumulative(double energy) const {
+		if(energy <= fEdges.front()) return 0;
+		if(energy >= fEdges.back()) return fCumulative.back();
+
+		// The bin that energy is in, and the fraction of it below energy
+		size_t bin = std::upper_bound(fEdges.begin(), fEdges.end(), \
+			energy) - fEdges.begin() - 1;
+		double fraction = (energy - fEdges[bin]) / \
+			(fEdges[bin + 1] - fEdges[bin]);
+		return fCumulative[bin] + \
+			fraction * (fCumulative[bin + 1] - fCumulative[bin]);
+	}
+
+	// The integral of the flux over [e_min, e_max)
+	double Integral(double e_min, double e_max) const {
+		return Cumulative(e_max) - Cumulative(e_min);
+	}
+
+	// The integral of the whole flux
+	double Integral() const { return fCumulative.back(); }
+
+	// The flux rebinned into the given bin edges, with each bin holding
+	// the integral of the flux over it. The caller owns the histogram.
+	TH1D* Rebinned(const char* name, const std::vector<double>& edges) \
+		const {
+		TH1D* rebinned = new TH1D(name, name, edges.size() - 1, &edges[0]);
+		rebinned->SetDirectory(nullptr);
+		for(size_t bin = 1; bin < edges.size(); bin++) {
+			rebinned->SetBinContent(bin, \
+				Integral(edges[bin - 1], edges[bin]));
+		}
+		return rebinned;
+	}
+
+	// The flux rebinned into the binning of an axis, e.g. the Enu axis of
+	// an analysis histogram
+	TH1D* Rebinned(const char* name, const TAxis* axis) const {
+		std::vector<double> edges(axis->GetNbins() + 1);
+		for(int bin = 1; bin <= axis->GetNbins(); bin++) {
+			edges[bin - 1] = axis->GetBinLowEdge(bin);
+		}
+		edges.back() = axis->GetBinUpEdge(axis->GetNbins());
+		return Rebinned(name, edges);
+	}
+
+ private:
+	std::vector<double> fEdges;
+	std::vector<double> fCumulative;
+
+	// The edges and contents of a histogram, as bytes, which identify the
+	// flux exactly
+	static std::string Key(const TH1* flux) {
+		std::vector<double> values;
+		for(int bin = 1; bin <= flux->GetNbinsX(); bin++) {
+			values.push_back(flux->GetXaxis()->GetBinLowEdge(bin));
+			values.push_back(flux->GetBinContent(bin));
+		}
+		values.push_back(flux->GetXaxis()->GetBinUpEdge(flux->GetNbinsX()));
+		return std::string((const char*) values.data(), \
+			values.size() * sizeof(double));
+	}
+};
+
+} // namespace convenient
+
+#endif // CONVENIENT_FLUX_H
@@ -0,0 +1,1017 @@
+// Author: Colin Weber (webe1077@umn.edu)
+// Date: 16 October 2026
+// Purpose: To define the on-disk layout of a CONVENIENT file in one place,
+// so that the converters write it and the analysis macros read it the same
+// way.
+//
+// Two layouts exist:
+// 	v1 : every final state species is a std::vector<std::vector<float>>
+// 		branch (e.g. FS_Protons), where each inner vector is a 4-momentum
+// 		(E, px, py, pz) and, for FS_Others, the PDG code as a 5th element.
+// 	v2 : every final state species is stored as flat, count-indexed float
+// 		arrays (e.g. FS_Protons_E[n_FS_Protons], FS_Protons_px[...], ...),
+// 		with an int array FS_Others_pdg[n_FS_Others] for other particles.
+// 		This avoids one heap allocation per particle on writing and the
+// 		nested streamer on reading, and compresses better.
+// In both layouts the particles of a species are ordered by decreasing
+// energy, and the counters n_FS_* are stored alongside. Files written in
+// the v2 layout also carry a TParameter<int> named ConvenientFormatVersion.
+//
+// Command: #include "convenient_format.h"
+// The directory containing this file is added to ROOT_INCLUDE_PATH by
+// setup_convenient.sh.
+
+#ifndef CONVENIENT_FORMAT_H
+#define CONVENIENT_FORMAT_H
+
+// Includes
+// ROOT includes
+#include "TFile.h"
+#include "TTree.h"
+#include "TBranch.h"
+#include "TH1.h"
+#include "TParameter.h"
+#include "TList.h"
+#include "TTreeReader.h"
+#include "TTreeReaderValue.h"
+#include "TTreeReaderArray.h"
+#include "RVersion.h" // For the compression algorithms of this ROOT
+
+// C++ includes
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace convenient {
+
+// Names of the objects stored in every CONVENIENT file
+const char* const kTreeName = "generator_data";
+const char* const kFluxName = "FlatTree_FLUX";
+const char* const kFormatVersionName = "ConvenientFormatVersion";
+const char* const kWeightScaleName = "ConvenientWeightScale";
+
+// The layout written by the converters in this repository
+const int kFormatVersion = 2;
+
+// The final state species kept by CONVENIENT. The order matches the order
+// in which the converters have always created the branches.
+enum Species {
+	kProtons = 0,
+	kAntiprotons,
+	kNeutrons,
+	kAntineutrons,
+	kGammas,
+	kPi0s,
+	kPiPs,
+	kPiMs,
+	kMuons,
+	kElectrons,
+	kTaus,
+	kNus,
+	kOthers,
+	kNSpecies
+};
+
+// The branch suffix of each species, i.e. FS_<name> and n_FS_<name>
+const char* const kSpeciesNames[kNSpecies] = {
+	"Protons", "Antiprotons", "Neutrons", "Antineutrons", "Gammas", "Pi0s",
+	"PiPs", "PiMs", "Muons", "Electrons", "Taus", "Nus", "Others"};
+
+inline std::string CounterBranchName(int species) {
+	return std::string("n_FS_") + kSpeciesNames[species];
+}
+
+inline std::string ParticleBranchName(int species) {
+	return std::string("FS_") + kSpeciesNames[species];
+}
+
+inline std::string ComponentBranchName(int species, const char* component) {
+	return ParticleBranchName(species) + "_" + component;
+}
+
+// Derived kinematics. These are quantities that almost every analysis 
+// computes from the final state particles. They can be computed once per 
+// file with NUISANCE/make_convenient_derived.C, which stores them as scalar 
+// branches of a friend tree of generator_data, so that analyses that only 
+// need them do not have to read the particle lists. The tree is stamped 
+// with kDerivedVersion, so a tree written with older definitions is 
+// recognized as stale.
+const char* const kDerivedTreeName = "derived_data";
+const char* const kDerivedVersionName = "ConvenientDerivedVersion";
+// Increase whenever the definition of a derived variable changes
+const int kDerivedVersion = 1;
+// The value of a derived variable that does not exist in an event, e.g. 
+// the muon kinematics of an event without a muon
+const float kNoValue = -999;
+
+enum DerivedVariable {
+	kEavail = 0, // Available energy, as in CAFAna/Vars/TruthVars.cxx
+	kQ2, // 4-momentum transfer squared to the leading final state lepton
+	kq0, // Energy transfer
+	kq3, // 3-momentum transfer
+	kTmu, // Kinetic energy of the leading muon
+	kCosThetaMu, // cos of the angle of the leading muon to the beam
+	// |p| of the leading particle of each species, at kLeadingP + species
+	kLeadingP,
+	// cos of the angle of the leading particle of each species to the 
+	// beam, at kLeadingCosTheta + species
+	kLeadingCosTheta = kLeadingP + kNSpecies,
+	kNDerived = kLeadingCosTheta + kNSpecies
+};
+
+inline std::string DerivedBranchName(int variable) {
+	const char* const names[kLeadingP] = {"Eavail", "Q2", "q0", "q3", \
+		"Tmu", "CosThetaMu"};
+	if(variable < kLeadingP) return names[variable];
+	if(variable < kLeadingCosTheta) {
+		return std::string("P_leading_") + kSpeciesNames[variable - kLeadingP];
+	}
+	return std::string("CosTheta_leading_") + \
+		kSpeciesNames[variable - kLeadingCosTheta];
+}
+
+// Masses used for the derived kinematics (GeV)
+constexpr float kMuonMass = 0.105658;
+constexpr float kChargedPionMass = 0.139570;
+constexpr float kProtonMass = 0.938272;
+
+// Split a space-separated list (as passed to the macros from the shell 
+// scripts) into its items
+inline std::vector<std::string> SplitList(const char* list) {
+	std::vector<std::string> items;
+	std::istringstream iss(list);
+	std::string item;
+	while(iss >> item) items.push_back(item);
+	return items;
+}
+
+// The largest |PDG code| classified through the lookup table below. Every 
+// code the converters treat specially is within this range, except for the 
+// hydrogen nucleus (1000010010), which is handled separately.
+const int kMaxTablePDG = 2212;
+
+// A table giving the species of every PDG code in [-kMaxTablePDG, 
+// kMaxTablePDG], built once on first use. It replaces a chain of 
+// comparisons per particle with a single lookup.
+inline const unsigned char* PDGTable() {
+	static const std::vector<unsigned char> table = [] {
+		std::vector<unsigned char> t(2 * kMaxTablePDG + 1, kOthers);
+		auto set = [&t](int pdg, Species s) { t[pdg + kMaxTablePDG] = s; };
+		set(2212, kProtons);
+		set(-2212, kAntiprotons);
+		set(2112, kNeutrons);
+		set(-2112, kAntineutrons);
+		set(22, kGammas);
+		set(111, kPi0s);
+		set(211, kPiPs);
+		set(-211, kPiMs);
+		for(int sign : {1, -1}) {
+			set(sign * 13, kMuons);
+			set(sign * 11, kElectrons);
+			set(sign * 15, kTaus);
+			set(sign * 12, kNus);
+			set(sign * 14, kNus);
+			set(sign * 16, kNus);
+		}
+		return t;
+	}();
+	return table.data();
+}
+
+// Assign a final state particle to a species using its PDG code. Free 
+// protons given as hydrogen nuclei are counted as protons.
+inline Species ClassifyPDG(int pdg) {
+	if(pdg >= -kMaxTablePDG && pdg <= kMaxTablePDG) {
+		return (Species) PDGTable()[pdg + kMaxTablePDG];
+	}
+	return (pdg == 1000010010) ? kProtons : kOthers;
+}
+
+// The final state particles of one species in one event, stored as a
+// structure of arrays. The buffers are reused from event to event, so after
+// the first few events no further allocations take place.
+struct ParticleList {
+	int n = 0;
+	std::vector<float> E;
+	std::vector<float> px;
+	std::vector<float> py;
+	std::vector<float> pz;
+	std::vector<int> pdg; // Only filled for kOthers
+
+	void Clear() { n = 0; }
+
+	void Push(float e, float x, float y, float z, int code = 0) {
+		if(n == (int) E.size()) {
+			// Grow geometrically so that repeated pushes stay cheap
+			int new_size = std::max(8, 2 * n);
+			E.resize(new_size);
+			px.resize(new_size);
+			py.resize(new_size);
+			pz.resize(new_size);
+			pdg.resize(new_size);
+		}
+		E[n] = e; px[n] = x; py[n] = y; pz[n] = z; pdg[n] = code;
+		n++;
+	}
+
+	// Order the particles by decreasing energy. The permutation and scratch
+	// buffers are members so that sorting does not allocate per event.
+	void SortByEnergy() {
+		if(n < 2) return;
+		order.resize(n);
+		std::iota(order.begin(), order.end(), 0);
+		std::sort(order.begin(), order.end(),
+			[this](int a, int b) { return E[a] > E[b]; });
+		Permute(E, scratch_f);
+		Permute(px, scratch_f);
+		Permute(py, scratch_f);
+		Permute(pz, scratch_f);
+		Permute(pdg, scratch_i);
+	}
+
+ private:
+	std::vector<int> order;
+	std::vector<float> scratch_f;
+	std::vector<int> scratch_i;
+
+	template <typename T>
+	void Permute(std::vector<T>& v, std::vector<T>& scratch) {
+		scratch.resize(n);
+		for(int i = 0; i < n; i++) scratch[i] = v[order[i]];
+		std::copy(scratch.begin(), scratch.begin() + n, v.begin());
+	}
+};
+
+// Everything CONVENIENT keeps for a single event
+struct Event {
+	float Enu = 0;
+	int PDGnu = 0;
+	int target_PDG = 0;
+	double EventWeight = 1;
+	double GenScaleFactor = 1;
+	bool flagCC = false;
+	bool flagNC = false;
+	// NEUT interaction code for NUISANCE-based files, GiBUU production ID
+	// for GiBUU files. The branch name differs accordingly.
+	int int_type = 0;
+	ParticleList fs[kNSpecies];
+
+	void ClearParticles() {
+		for(int s = 0; s < kNSpecies; s++) fs[s].Clear();
+	}
+
+	// Add a particle to the species determined by its PDG code
+	void AddParticle(int pdg, float e, float x, float y, float z) {
+		fs[ClassifyPDG(pdg)].Push(e, x, y, z, pdg);
+	}
+
+	void SortByEnergy() {
+		for(int s = 0; s < kNSpecies; s++) fs[s].SortByEnergy();
+	}
+};
+
+// The selection index. The converters write, next to generator_data, a 
+// small tree with one entry per event holding only what most selections 
+// look at first: the neutrino PDG code, the CC/NC flags, the interaction 
+// type, and the multiplicity of each species. An analysis can read this 
+// tree (a few bytes per event) to find the entries it needs, and then read 
+// only those entries of generator_data. See SelectEntries.
+const char* const kIndexTreeName = "selection_index";
+// Multiplicities are packed into 4 bits per species, so in the index a 
+// multiplicity of kIndexMaxMultiplicity means that many or more
+const int kIndexMaxMultiplicity = 15;
+
+// One entry of the selection index
+struct IndexEntry {
+	Short_t PDGnu = 0;
+	UChar_t flags = 0; // Bit 0: flagCC, bit 1: flagNC
+	Short_t int_type = 0;
+	ULong64_t multiplicities = 0; // 4 bits per species, kProtons lowest
+
+	bool flagCC() const { return flags & 1; }
+	bool flagNC() const { return flags & 2; }
+	// The multiplicity of a species, up to kIndexMaxMultiplicity
+	int N(Species s) const { return (multiplicities >> (4 * s)) & 0xF; }
+
+	void Set(const Event& event) {
+		PDGnu = event.PDGnu;
+		flags = (event.flagCC ? 1 : 0) | (event.flagNC ? 2 : 0);
+		int_type = event.int_type;
+		multiplicities = 0;
+		for(int s = 0; s < kNSpecies; s++) {
+			ULong64_t n = std::min(event.fs[s].n, kIndexMaxMultiplicity);
+			multiplicities |= n << (4 * s);
+		}
+	}
+
+	// Create the branches of an index tree, or point an existing index 
+	// tree to this entry
+	void Branch(TTree* index) {
+		index->Branch("PDGnu", &PDGnu, "PDGnu/S");
+		index->Branch("flags", &flags, "flags/b");
+		index->Branch("int_type", &int_type, "int_type/S");
+		index->Branch("multiplicities", &multiplicities, "multiplicities/l");
+	}
+	void SetBranchAddresses(TTree* index) {
+		index->SetBranchAddress("PDGnu", &PDGnu);
+		index->SetBranchAddress("flags", &flags);
+		index->SetBranchAddress("int_type", &int_type);
+		index->SetBranchAddress("multiplicities", &multiplicities);
+	}
+};
+
+// Decides from its index entry whether an event may pass a selection
+typedef std::function<bool(const IndexEntry&)> IndexSelection;
+
+// Collects the entries of the file whose index entry passes selection. 
+// Returns false, leaving entries empty, if the file has no index (or one 
+// that doesn't match generator_data), in which case every entry has to be 
+// read.
+inline bool SelectEntries(TDirectory* file, const IndexSelection& selection, \
+	std::vector<Long64_t>& entries) {
+	entries.clear();
+	TTree* index = (TTree*) file->Get(kIndexTreeName);
+	TTree* tree = (TTree*) file->Get(kTreeName);
+	if(!index || !tree || index->GetEntries() != tree->GetEntries()) {
+		return false;
+	}
+	IndexEntry entry;
+	entry.SetBranchAddresses(index);
+	Long64_t n_entries = index->GetEntries();
+	for(Long64_t i = 0; i < n_entries; i++) {
+		index->GetEntry(i);
+		if(selection(entry)) entries.push_back(i);
+	}
+	index->ResetBranchAddresses();
+	return true;
+}
+
+// The write policy of an output: how its trees are compressed, how large
+// their baskets and clusters are, and how many bits of the mantissa of the
+// four-momenta are kept. Fewer mantissa bits leave the stored momenta
+// exactly as floats, but with their lowest bits zeroed, which the
+// compression then squeezes out. The relative error this introduces is at
+// most Tolerance(). The policy is chosen by name (see GetWritePolicy),
+// normally through the CONVENIENT_WRITE_POLICY environment variable that
+// run.sh sets from WRITE_POLICIES in set_run_variables.sh.
+const char* const kWritePolicyVariable = "CONVENIENT_WRITE_POLICY";
+const char* const kMantissaBitsName = "ConvenientMantissaBits";
+// The number of mantissa bits of a float, i.e. full precision
+const int kFullMantissaBits = 23;
+// The compression of the archive policies. ZSTD came with ROOT 6.20, so
+// older versions (e.g. the 6.12 set up by global_vars.sh) use LZMA, which
+// compresses about as well but is slower.
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,20,0)
+const int kArchiveCompression = 509; // ZSTD level 9
+#else
+const int kArchiveCompression = 208; // LZMA level 8
+#endif
+
+struct WritePolicy {
+	std::string name = "default";
+	// ROOT compression setting, algorithm * 100 + level (e.g. 404 for LZ4
+	// level 4, 509 for ZSTD level 9). -1 leaves the file's setting alone.
+	int compression = -1;
+	// Bytes per basket of each branch. 0 leaves ROOT's default.
+	int basket_size = 0;
+	// As for TTree::SetAutoFlush: entries per cluster if positive, bytes
+	// per cluster if negative. 0 leaves ROOT's default.
+	Long64_t auto_flush = 0;
+	// Mantissa bits kept for E, px, py, and pz
+	int mantissa_bits = kFullMantissaBits;
+
+	// The largest relative error of a stored four-momentum component
+	double Tolerance() const {
+		return (mantissa_bits >= kFullMantissaBits) ? 0 : \
+			std::ldexp(1.0, -(mantissa_bits + 1));
+	}
+};
+
+// Look up a write policy by name. The names are
+// 	default : ROOT's defaults and full precision, as always
+// 	analysis : LZ4, for samples that are read often, with larger baskets
+// 		so that a full scan makes fewer, larger reads
+// 	archive : ZSTD (LZMA before ROOT 6.20) at a high level, with large
+// 		clusters, for samples that are kept but seldom read
+// 	compact : archive, with 12 mantissa bits (a relative tolerance of
+// 		1.2e-4, far below any detector resolution)
+// Any name may be followed by :<bits> to keep that many mantissa bits,
+// e.g. analysis:16. Returns false if the name is unknown.
+inline bool GetWritePolicy(const std::string& full_name, \
+	WritePolicy& policy) {
+	policy = WritePolicy();
+	policy.name = full_name;
+	std::string name = full_name;
+	size_t colon = name.find(':');
+	if(colon != std::string::npos) {
+		policy.mantissa_bits = std::atoi(name.c_str() + colon + 1);
+		name.erase(colon);
+		if(policy.mantissa_bits < 1 || \
+			policy.mantissa_bits > kFullMantissaBits) {
+			return false;
+		}
+	}
+	if(name == "default" || name == "") {
+		return true;
+	}
+	if(name == "analysis") {
+		policy.compression = 404;
+		policy.basket_size = 256000;
+		policy.auto_flush = -30000000;
+		return true;
+	}
+	if(name == "archive" || name == "compact") {
+		policy.compression = kArchiveCompression;
+		policy.basket_size = 512000;
+		policy.auto_flush = -100000000;
+		if(name == "compact" && colon == std::string::npos) {
+			policy.mantissa_bits = 12;
+		}
+		return true;
+	}
+	return false;
+}
+
+// The write policy named by CONVENIENT_WRITE_POLICY, or the default one if
+// it isn't set or is unknown
+inline WritePolicy WritePolicyFromEnvironment() {
+	WritePolicy policy;
+	const char* name = std::getenv(kWritePolicyVariable);
+	if(name && !GetWritePolicy(name, policy)) {
+		std::cout << "Unknown write policy " << name << \
+			".  Using the default one.\n";
+		policy = WritePolicy();
+	}
+	return policy;
+}
+
+// Apply the compression, basket size, and cluster size of a policy to a
+// tree that is filled by copying the entries of another, e.g. an empty
+// clone made with CloneTree(0), whose branches otherwise keep the settings
+// of the input. The values are copied as they are, so the mantissa bits of
+// the policy are not applied (see ReadMantissaBits).
+inline void ApplyWritePolicy(TTree* tree, const WritePolicy& policy) {
+	if(policy.compression >= 0) {
+		TFile* file = tree->GetCurrentFile();
+		if(file) file->SetCompressionSettings(policy.compression);
+		TIter next(tree->GetListOfBranches());
+		while(TBranch* branch = (TBranch*) next()) {
+			branch->SetCompressionSettings(policy.compression);
+		}
+	}
+	if(policy.basket_size > 0) tree->SetBasketSize("*", policy.basket_size);
+	if(policy.auto_flush != 0) tree->SetAutoFlush(policy.auto_flush);
+}
+
+// The number of mantissa bits kept for the four-momenta of the events in
+// dir (see WritePolicy), or kFullMantissaBits if they were not reduced
+inline int ReadMantissaBits(TDirectory* dir) {
+	TParameter<int>* bits = (TParameter<int>*) dir->Get(kMantissaBitsName);
+	return bits ? bits->GetVal() : kFullMantissaBits;
+}
+
+// Store the mantissa bits in dir, if they are reduced. Macros that copy
+// the events of a file copy its mantissa bits with them.
+inline void WriteMantissaBits(TDirectory* dir, int mantissa_bits) {
+	if(mantissa_bits >= kFullMantissaBits) return;
+	TParameter<int> bits(kMantissaBitsName, mantissa_bits);
+	dir->WriteTObject(&bits, kMantissaBitsName, "WriteDelete");
+}
+
+// Round a float to the nearest value with the given number of mantissa
+// bits. Infinities and NaNs are left as they are.
+inline float RoundMantissa(float x, int bits) {
+	if(bits >= kFullMantissaBits) return x;
+	unsigned int u;
+	std::memcpy(&u, &x, sizeof(u));
+	if((u & 0x7f800000u) == 0x7f800000u) return x;
+	unsigned int drop = kFullMantissaBits - bits;
+	// Adding half of the last kept bit before truncating rounds to the
+	// nearest value. A carry into the exponent is still correct.
+	u = (u + (1u << (drop - 1))) & ~((1u << drop) - 1);
+	std::memcpy(&x, &u, sizeof(x));
+	return x;
+}
+
+// Creates the branches of a v2 CONVENIENT tree and fills it from an Event.
+class TreeWriter {
+ public:
+	// int_type_name is "NEUT_int_type" for NUISANCE-based files and "Mode"
+	// for GiBUU files. The tree is written following policy, which by
+	// default is the one named by CONVENIENT_WRITE_POLICY.
+	TreeWriter(TTree* tree, Event* event,
+		const char* int_type_name = "NEUT_int_type",
+		const WritePolicy& policy = WritePolicyFromEnvironment()) :
+		fTree(tree), fEvent(event), fPolicy(policy) {
+		// Branches take the compression of their file when they are
+		// created, so set it first
+		TFile* file = fTree->GetCurrentFile();
+		if(file && fPolicy.compression >= 0) {
+			file->SetCompressionSettings(fPolicy.compression);
+		}
+
+		// The selection index lives in the same directory as the tree
+		fIndex = new TTree(kIndexTreeName, "Selection index of generator_data");
+		fIndex->SetDirectory(fTree->GetDirectory());
+		fIndexEntry.Branch(fIndex);
+
+		fTree->Branch("Enu", &fEvent->Enu, "Enu/F");
+		fTree->Branch("PDGnu", &fEvent->PDGnu, "PDGnu/I");
+		fTree->Branch("target_PDG", &fEvent->target_PDG, "target_PDG/I");
+		fTree->Branch("EventWeight", &fEvent->EventWeight, "EventWeight/D");
+		fTree->Branch("GenScaleFactor", &fEvent->GenScaleFactor, \
+			"GenScaleFactor/D");
+		fTree->Branch("flagCC", &fEvent->flagCC, "flagCC/O");
+		fTree->Branch("flagNC", &fEvent->flagNC, "flagNC/O");
+		fTree->Branch(int_type_name, &fEvent->int_type, \
+			(std::string(int_type_name) + "/I").c_str());
+
+		// The counters have to exist before the arrays that they index
+		for(int s = 0; s < kNSpecies; s++) {
+			std::string counter = CounterBranchName(s);
+			fTree->Branch(counter.c_str(), &fEvent->fs[s].n, \
+				(counter + "/I").c_str());
+		}
+		for(int s = 0; s < kNSpecies; s++) {
+			ParticleList& list = fEvent->fs[s];
+			// Make sure the buffers exist so the branch addresses are valid
+			if(list.E.empty()) {
+				list.Push(0, 0, 0, 0);
+				list.Clear();
+			}
+			fArrays[s][0] = MakeArrayBranch(s, "E", "F", list.E.data());
+			fArrays[s][1] = MakeArrayBranch(s, "px", "F", list.px.data());
+			fArrays[s][2] = MakeArrayBranch(s, "py", "F", list.py.data());
+			fArrays[s][3] = MakeArrayBranch(s, "pz", "F", list.pz.data());
+			fArrays[s][4] = (s == kOthers) ? \
+				MakeArrayBranch(s, "pdg", "I", list.pdg.data()) : nullptr;
+			fCapacity[s] = list.E.size();
+		}
+
+		if(fPolicy.basket_size > 0) {
+			fTree->SetBasketSize("*", fPolicy.basket_size);
+		}
+		if(fPolicy.auto_flush != 0) fTree->SetAutoFlush(fPolicy.auto_flush);
+	}
+
+	// Fill the tree with the current contents of the event. Buffers that
+	// have grown since the last fill get their branch addresses updated.
+	void Fill() {
+		for(int s = 0; s < kNSpecies; s++) {
+			ParticleList& list = fEvent->fs[s];
+			if(list.E.size() != fCapacity[s]) {
+				fArrays[s][0]->SetAddress(list.E.data());
+				fArrays[s][1]->SetAddress(list.px.data());
+				fArrays[s][2]->SetAddress(list.py.data());
+				fArrays[s][3]->SetAddress(list.pz.data());
+				if(fArrays[s][4]) fArrays[s][4]->SetAddress(list.pdg.data());
+				fCapacity[s] = list.E.size();
+			}
+			// Drop the mantissa bits the policy doesn't keep. This is done
+			// in place, and rounding again to the same bits changes nothing,
+			// so an event can be filled into several writers.
+			if(fPolicy.mantissa_bits < kFullMantissaBits) {
+				int bits = fPolicy.mantissa_bits;
+				for(int i = 0; i < list.n; i++) {
+					list.E[i] = RoundMantissa(list.E[i], bits);
+					list.px[i] = RoundMantissa(list.px[i], bits);
+					list.py[i] = RoundMantissa(list.py[i], bits);
+					list.pz[i] = RoundMantissa(list.pz[i], bits);
+				}
+			}
+		}
+		fTree->Fill();
+		fIndexEntry.Set(*fEvent);
+		fIndex->Fill();
+	}
+
+	// Write the tree and its selection index to their directory. If the
+	// four-momenta were stored with reduced precision, the number of
+	// mantissa bits kept is stored alongside.
+	void Write() {
+		fTree->Write();
+		fIndex->Write();
+		WriteMantissaBits(fTree->GetDirectory(), fPolicy.mantissa_bits);
+	}
+
+ private:
+	TTree* fTree;
+	Event* fEvent;
+	WritePolicy fPolicy;
+	TTree* fIndex;
+	IndexEntry fIndexEntry;
+	TBranch* fArrays[kNSpecies][5];
+	size_t fCapacity[kNSpecies];
+
+	TBranch* MakeArrayBranch(int species, const char* component,
+		const char* type, void* address) {
+		std::string name = ComponentBranchName(species, component);
+		std::string leaflist = name + "[" + CounterBranchName(species) + \
+			"]/" + type;
+		return fTree->Branch(name.c_str(), address, leaflist.c_str());
+	}
+};
+
+// Stamp the format version into the current directory (i.e. the output
+// file). Readers do not rely on it, but it makes files self-describing.
+inline void WriteFormatVersion() {
+	TParameter<int> version(kFormatVersionName, kFormatVersion);
+	version.Write();
+}
+
+// The file-level weight scale of a CONVENIENT file. Every event weight in 
+// the file is to be multiplied by it, so reweighting a whole file by a 
+// constant only needs this one number to be changed. Files without it 
+// have a scale of 1.
+inline double ReadWeightScale(TDirectory* dir) {
+	TParameter<double>* scale = (TParameter<double>*) \
+		dir->Get(kWeightScaleName);
+	return scale ? scale->GetVal() : 1.;
+}
+
+// Store the weight scale in dir, replacing any scale already there
+inline void WriteWeightScale(TDirectory* dir, double scale) {
+	TParameter<double> parameter(kWeightScaleName, scale);
+	dir->WriteTObject(&parameter, kWeightScaleName, "WriteDelete");
+}
+
+// The version of the derived kinematics stored in dir, or 0 if none are
+inline int ReadDerivedVersion(TDirectory* dir) {
+	TParameter<int>* version = (TParameter<int>*) \
+		dir->Get(kDerivedVersionName);
+	return version ? version->GetVal() : 0;
+}
+
+inline void WriteDerivedVersion(TDirectory* dir) {
+	TParameter<int> version(kDerivedVersionName, kDerivedVersion);
+	dir->WriteTObject(&version, kDerivedVersionName, "WriteDelete");
+}
+
+// A composite file describes a sample of a composite target (e.g. the
+// NOvA ND) made from existing CONVENIENT files of its elements, without
+// copying their events. In place of generator_data, it holds a small tree
+// with one entry per element file: its name, the target it was made for,
+// the fractional composition of that target, and the weight with which its
+// events enter the composite (the fraction, shared between the files of
+// the same element by their number of events). Next to the tree is the
+// flux common to all the element files. The element files keep their own
+// weight scales and generator scale factors. See
+// NUISANCE/make_convenient_composite_from_elements.C.
+const char* const kCompositeTreeName = "composite_elements";
+
+struct CompositeElement {
+	std::string filename;
+	int target_PDG = 0;
+	double fraction = 0;
+	double weight = 0;
+	Long64_t n_entries = 0;
+};
+
+// The elements of a composite file, or none if dir is not a composite
+// file. Relative file names are taken relative to the directory of the
+// composite file.
+inline std::vector<CompositeElement> ReadComposite(TDirectory* dir) {
+	std::vector<CompositeElement> elements;
+	TTree* tree = (TTree*) dir->Get(kCompositeTreeName);
+	if(!tree) return elements;
+	std::string* filename = nullptr;
+	CompositeElement element;
+	tree->SetBranchAddress("filename", &filename);
+	tree->SetBranchAddress("target_PDG", &element.target_PDG);
+	tree->SetBranchAddress("fraction", &element.fraction);
+	tree->SetBranchAddress("weight", &element.weight);
+	tree->SetBranchAddress("n_entries", &element.n_entries);
+	std::string base;
+	TFile* file = dir->GetFile();
+	if(file) {
+		base = file->GetName();
+		size_t slash = base.find_last_of('/');
+		base = (slash == std::string::npos) ? "" : base.substr(0, slash + 1);
+	}
+	for(Long64_t i = 0; i < tree->GetEntries(); i++) {
+		tree->GetEntry(i);
+		element.filename = *filename;
+		if(!element.filename.empty() && element.filename[0] != '/') {
+			element.filename = base + element.filename;
+		}
+		elements.push_back(element);
+	}
+	tree->ResetBranchAddresses();
+	delete filename;
+	return elements;
+}
+
+// Write the tree of a composite file into the current directory
+inline void WriteComposite(const std::vector<CompositeElement>& elements) {
+	TTree tree(kCompositeTreeName, kCompositeTreeName);
+	CompositeElement element;
+	std::string* filename = &element.filename;
+	tree.Branch("filename", &filename);
+	tree.Branch("target_PDG", &element.target_PDG, "target_PDG/I");
+	tree.Branch("fraction", &element.fraction, "fraction/D");
+	tree.Branch("weight", &element.weight, "weight/D");
+	tree.Branch("n_entries", &element.n_entries, "n_entries/L");
+	for(const CompositeElement& e : elements) {
+		element = e;
+		tree.Fill();
+	}
+	tree.Write();
+}
+
+// Determine the layout of a CONVENIENT tree from its branches
+inline int DetectFormatVersion(TTree* tree) {
+	if(tree->GetBranch(ComponentBranchName(kProtons, "E").c_str())) return 2;
+	return 1;
+}
+
+// A read-only view of the particles of one species in the current entry of
+// a Reader. It works identically for v1 and v2 files, so analyses never
+// need to know which layout they are reading.
+class ParticleView {
+ public:
+	int size() const {
+		if(fNested) return fNested->GetSize();
+		return fComponents[0] ? fComponents[0]->GetSize() : 0;
+	}
+	float E(int i) const { return Get(i, 0); }
+	float px(int i) const { return Get(i, 1); }
+	float py(int i) const { return Get(i, 2); }
+	float pz(int i) const { return Get(i, 3); }
+	// Only meaningful for kOthers
+	int pdg(int i) const {
+		if(fNested) return (int) (*fNested)[i][4];
+		return fPDG ? (*fPDG)[i] : 0;
+	}
+	// The 4-momentum in the (E, px, py, pz) order of the v1 layout
+	std::vector<float> P4(int i) const {
+		return {E(i), px(i), py(i), pz(i)};
+	}
+
+ private:
+	friend class Reader;
+	TTreeReaderArray<std::vector<float>>* fNested = nullptr;
+	TTreeReaderArray<float>* fComponents[4] = {nullptr, nullptr, nullptr,
+		nullptr};
+	TTreeReaderArray<int>* fPDG = nullptr;
+
+	float Get(int i, int c) const {
+		if(fNested) return (*fNested)[i][c];
+		return (*fComponents[c])[i];
+	}
+};
+
+// Reads a CONVENIENT tree of either layout. Typical use:
+// 	convenient::Reader reader(file);
+// 	while(reader.Next()) {
+// 		if(reader.PDGnu() != 14 || !reader.flagCC()) continue;
+// 		const convenient::ParticleView& pips =
+// 			reader.Particles(convenient::kPiPs);
+// 		if(pips.size() > 0) h->Fill(pips.E(0), reader.Weight());
+// 	}
+class Reader {
+ public:
+	explicit Reader(TFile* file) :
+		fReader(kTreeName, file), fFile(file) {
+		TTree* tree = (TTree*) file->Get(kTreeName);
+		fWeightScale = ReadWeightScale(file);
+		Init(tree);
+		InitDerived(tree);
+	}
+
+	bool Next() { return fReader.Next(); }
+	int Version() const { return fVersion; }
+	TTreeReader& GetTreeReader() { return fReader; }
+	Long64_t GetCurrentEntry() const { return fReader.GetCurrentEntry(); }
+	Long64_t GetEntries() { return fReader.GetEntries(false); }
+	// Load a given entry instead of the next one. Returns false if it 
+	// could not be loaded.
+	bool SetEntry(Long64_t entry) {
+		return fReader.SetEntry(entry) == TTreeReader::kEntryValid;
+	}
+	// Restrict Next() to the entries [begin, end). Must be called before 
+	// the first call to Next().
+	void SetEntriesRange(Long64_t begin, Long64_t end) {
+		fReader.SetEntriesRange(begin, end);
+	}
+
+	float Enu() { return **fEnu; }
+	int PDGnu() { return **fPDGnu; }
+	int target_PDG() { return **fTargetPDG; }
+	bool flagCC() { return **fFlagCC; }
+	bool flagNC() { return **fFlagNC; }
+	// The event weight, including the file-level weight scale and the 
+	// scale of the current entry
+	double EventWeight() {
+		return **fEventWeight * fWeightScale * fEntryScale;
+	}
+	double WeightScale() const { return fWeightScale; }
+	// An extra factor for the weight of the current entry, e.g. 1 / the 
+	// probability with which it was kept in a subsample (see 
+	// convenient_subsample.h). Stays until it is set again.
+	void SetEntryScale(double scale) { fEntryScale = scale; }
+	double GenScaleFactor() { return **fGenScaleFactor; }
+	// NEUT_int_type for NUISANCE-based files, Mode for GiBUU files
+	int IntType() { return **fIntType; }
+	// The full per-event weight that converts an event count to a cross
+	// section, up to the flux normalization
+	double Weight() { return EventWeight() * GenScaleFactor(); }
+
+	int N(Species s) { return **fCounters[s]; }
+	const ParticleView& Particles(Species s) const { return fViews[s]; }
+
+	// The flux the events were generated with
+	TH1D* Flux() { return (TH1D*) fFile->Get(kFluxName); }
+	TFile* GetFile() const { return fFile; }
+
+	// A derived variable of the current entry. It is read from the derived 
+	// tree if the file has an up-to-date one, and computed from the 
+	// particles (once per entry) otherwise.
+	float Derived(DerivedVariable variable);
+	bool HasDerivedTree() const { return fDerivedValues[0] != nullptr; }
+
+ private:
+	TTreeReader fReader;
+	TFile* fFile;
+	int fVersion = 1;
+	double fWeightScale = 1;
+	double fEntryScale = 1;
+
+	std::unique_ptr<TTreeReaderValue<float>> fEnu;
+	std::unique_ptr<TTreeReaderValue<int>> fPDGnu;
+	std::unique_ptr<TTreeReaderValue<int>> fTargetPDG;
+	std::unique_ptr<TTreeReaderValue<bool>> fFlagCC;
+	std::unique_ptr<TTreeReaderValue<bool>> fFlagNC;
+	std::unique_ptr<TTreeReaderValue<double>> fEventWeight;
+	std::unique_ptr<TTreeReaderValue<double>> fGenScaleFactor;
+	std::unique_ptr<TTreeReaderValue<int>> fIntType;
+	std::unique_ptr<TTreeReaderValue<int>> fCounters[kNSpecies];
+
+	std::vector<std::unique_ptr<TTreeReaderArray<std::vector<float>>>> fNested;
+	std::vector<std::unique_ptr<TTreeReaderArray<float>>> fFloatArrays;
+	std::vector<std::unique_ptr<TTreeReaderArray<int>>> fIntArrays;
+	ParticleView fViews[kNSpecies];
+
+	std::unique_ptr<TTreeReaderValue<float>> fDerivedValues[kNDerived];
+	float fDerived[kNDerived];
+	Long64_t fDerivedEntry = -1;
+
+	// Attach the derived tree of the file as a friend, if it is up to date
+	void InitDerived(TTree* tree) {
+		TTree* derived = (TTree*) fFile->Get(kDerivedTreeName);
+		if(!derived) return;
+		if(ReadDerivedVersion(fFile) != kDerivedVersion || \
+			derived->GetEntries() != tree->GetEntries()) {
+			std::cout << "The " << kDerivedTreeName << " tree of " << \
+				fFile->GetName() << " is stale, so derived variables " << \
+				"will be computed on the fly. Rerun " << \
+				"make_convenient_derived.C to update it.\n";
+			return;
+		}
+		// Several readers may be opened on the same file one after the 
+		// other, so only add the friend once
+		if(!tree->GetListOfFriends() || \
+			!tree->GetListOfFriends()->FindObject(kDerivedTreeName)) {
+			tree->AddFriend(derived);
+		}
+		for(int v = 0; v < kNDerived; v++) {
+			fDerivedValues[v].reset(new TTreeReaderValue<float>(fReader, \
+				DerivedBranchName(v).c_str()));
+		}
+	}
+
+	void Init(TTree* tree) {
+		fVersion = DetectFormatVersion(tree);
+		fEnu.reset(new TTreeReaderValue<float>(fReader, "Enu"));
+		fPDGnu.reset(new TTreeReaderValue<int>(fReader, "PDGnu"));
+		fTargetPDG.reset(new TTreeReaderValue<int>(fReader, "target_PDG"));
+		fFlagCC.reset(new TTreeReaderValue<bool>(fReader, "flagCC"));
+		fFlagNC.reset(new TTreeReaderValue<bool>(fReader, "flagNC"));
+		fEventWeight.reset(new TTreeReaderValue<double>(fReader, \
+			"EventWeight"));
+		fGenScaleFactor.reset(new TTreeReaderValue<double>(fReader, \
+			"GenScaleFactor"));
+		// GiBUU files store the GiBUU production ID in "Mode" instead
+		const char* int_type_name = tree->GetBranch("NEUT_int_type") ? \
+			"NEUT_int_type" : "Mode";
+		fIntType.reset(new TTreeReaderValue<int>(fReader, int_type_name));
+
+		for(int s = 0; s < kNSpecies; s++) {
+			fCounters[s].reset(new TTreeReaderValue<int>(fReader, \
+				CounterBranchName(s).c_str()));
+			if(fVersion == 1) {
+				fNested.emplace_back(new TTreeReaderArray<std::vector<float>>(\
+					fReader, ParticleBranchName(s).c_str()));
+				fViews[s].fNested = fNested.back().get();
+				continue;
+			}
+			const char* components[4] = {"E", "px", "py", "pz"};
+			for(int c = 0; c < 4; c++) {
+				fFloatArrays.emplace_back(new TTreeReaderArray<float>(fReader, \
+					ComponentBranchName(s, components[c]).c_str()));
+				fViews[s].fComponents[c] = fFloatArrays.back().get();
+			}
+			if(s == kOthers) {
+				fIntArrays.emplace_back(new TTreeReaderArray<int>(fReader, \
+					ComponentBranchName(s, "pdg").c_str()));
+				fViews[s].fPDG = fIntArrays.back().get();
+			}
+		}
+	}
+};
+
+// The contribution of a final state particle to the available energy, 
+// following the NOvA method implemented in CAFAna/Vars/TruthVars.cxx
+inline float EavailContribution(int pdg, float E) {
+	if(pdg == 2212) return E - kProtonMass;
+	if(std::abs(pdg) == 211) return E - kChargedPionMass;
+	if(pdg == 111 || pdg == 11 || pdg == 22) return E;
+	if(pdg >= 1000000000) return 0;
+	if(pdg >= 2000 && pdg != 2112) return E - kProtonMass;
+	if(pdg <= -2000) return E + kProtonMass;
+	if(pdg != 2112 && (std::abs(pdg) < 11 || std::abs(pdg) > 16)) return E;
+	return 0;
+}
+
+// Compute every derived variable of the current entry of a reader into 
+// values, which must hold kNDerived floats
+inline void ComputeDerived(Reader& reader, float* values) {
+	// Leading particle of each species. The particles are ordered by 
+	// decreasing energy, so the leading one is always the first.
+	for(int s = 0; s < kNSpecies; s++) {
+		values[kLeadingP + s] = kNoValue;
+		values[kLeadingCosTheta + s] = kNoValue;
+		const ParticleView& particles = reader.Particles((Species) s);
+		if(particles.size() == 0) continue;
+		float px = particles.px(0), py = particles.py(0), pz = particles.pz(0);
+		float p = std::sqrt(px * px + py * py + pz * pz);
+		values[kLeadingP + s] = p;
+		if(p > 0) values[kLeadingCosTheta + s] = pz / p;
+	}
+
+	// Leading muon
+	const ParticleView& muons = reader.Particles(kMuons);
+	values[kTmu] = (muons.size() > 0) ? muons.E(0) - kMuonMass : kNoValue;
+	values[kCosThetaMu] = values[kLeadingCosTheta + kMuons];
+
+	// Energy and momentum transfer to the leading final state lepton: the 
+	// charged lepton of the neutrino's flavor for CC events, and the 
+	// neutrino for NC events. The neutrino travels along z.
+	Species lepton = kNus;
+	if(reader.flagCC()) {
+		int flavor = std::abs(reader.PDGnu());
+		lepton = (flavor == 12) ? kElectrons : \
+			(flavor == 16) ? kTaus : kMuons;
+	}
+	const ParticleView& leptons = reader.Particles(lepton);
+	if(leptons.size() > 0) {
+		float Enu = reader.Enu();
+		float q0 = Enu - leptons.E(0);
+		float qx = -leptons.px(0), qy = -leptons.py(0);
+		float qz = Enu - leptons.pz(0);
+		float q3 = std::sqrt(qx * qx + qy * qy + qz * qz);
+		values[kq0] = q0;
+		values[kq3] = q3;
+		values[kQ2] = q3 * q3 - q0 * q0;
+	}
+	else {
+		values[kq0] = kNoValue;
+		values[kq3] = kNoValue;
+		values[kQ2] = kNoValue;
+	}
+
+	// Available energy. Electrons and positrons are stored together and 
+	// count equally, so their full energy is used.
+	float Eavail = 0;
+	const int species_pdg[kNSpecies] = {2212, -2212, 2112, -2112, 22, 111, \
+		211, -211, 13, 11, 15, 14, 0};
+	for(int s = 0; s < kNSpecies; s++) {
+		const ParticleView& particles = reader.Particles((Species) s);
+		for(int i = 0; i < particles.size(); i++) {
+			int pdg = (s == kOthers) ? particles.pdg(i) : species_pdg[s];
+			Eavail += EavailContribution(pdg, particles.E(i));
+		}
+	}
+	values[kEavail] = Eavail;
+}
+
+inline float Reader::Derived(DerivedVariable variable) {
+	if(HasDerivedTree()) return **fDerivedValues[variable];
+	Long64_t entry = GetCurrentEntry();
+	if(entry != fDerivedEntry) {
+		ComputeDerived(*this, fDerived);
+		fDerivedEntry = entry;
+	}
+	return fDerived[variable];
+}
+
+} // namespace convenient
+
+#endif // CONVENIENT_FORMAT_H
@@ -0,0 +1,207 @@
+// Author: Colin Weber (webe1077@umn.edu)
+// Date: 16 October 2026
+// Purpose: To compute the kinematics of many final state particles at once.
+// The functions here take the particles of a species as separate,
+// contiguous arrays of E, px, py, and pz (the layout of ParticleList and of
+// v2 CONVENIENT files) and loop over them with simple, branch-free loops
+// that the compiler can vectorize. Quantities that depend on the species
+// (masses and the available energy) are selected at compile time through
+// SpeciesTraits, so no per-particle dispatch on the species is needed.
+//
+// Command: #include "convenient_kinematics.h"
+// Typical use, inside an event loop:
+// 	convenient::ParticleBatch protons; // Declared once, outside the loop
+// 	...
+// 	protons.Load(reader.Particles(convenient::kProtons));
+// 	convenient::kinematics::Momentum(protons.px.data(),
+// 		protons.py.data(), protons.pz.data(), protons.n, p.data());
+// 	float Eavail = convenient::kinematics::Eavail<convenient::kProtons>(
+// 		protons.E.data(), protons.n);
+// All angles are with respect to the neutrino direction, which is along z.
+// The scalar functions give the same results as the helpers in
+// xsec_analysis_macro.C for a single particle.
+
+#ifndef CONVENIENT_KINEMATICS_H
+#define CONVENIENT_KINEMATICS_H
+
+// Includes
+// CONVENIENT includes
+#include "convenient_format.h" // For the species, masses, and ParticleView
+
+// C++ includes
+#include <cmath>
+#include <vector>
+
+namespace convenient {
+
+// The compile-time properties of each species. The contribution of a
+// particle of the species to the available energy is
+// kEavailScale * E + kEavailOffset, which is the same as
+// EavailContribution for the PDG code of the species.
+template <int S> struct SpeciesTraits;
+
+#define CONVENIENT_SPECIES_TRAITS(S, MASS, SCALE, OFFSET) \
+	template <> struct SpeciesTraits<S> { \
+		static constexpr float Mass() { return MASS; } \
+		static constexpr float EavailScale() { return SCALE; } \
+		static constexpr float EavailOffset() { return OFFSET; } \
+	};
+CONVENIENT_SPECIES_TRAITS(kProtons, kProtonMass, 1, -kProtonMass)
+CONVENIENT_SPECIES_TRAITS(kAntiprotons, kProtonMass, 1, kProtonMass)
+CONVENIENT_SPECIES_TRAITS(kNeutrons, 0.939565, 0, 0)
+CONVENIENT_SPECIES_TRAITS(kAntineutrons, 0.939565, 1, kProtonMass)
+CONVENIENT_SPECIES_TRAITS(kGammas, 0, 1, 0)
+CONVENIENT_SPECIES_TRAITS(kPi0s, 0.134977, 1, 0)
+CONVENIENT_SPECIES_TRAITS(kPiPs, kChargedPionMass, 1, -kChargedPionMass)
+CONVENIENT_SPECIES_TRAITS(kPiMs, kChargedPionMass, 1, -kChargedPionMass)
+CONVENIENT_SPECIES_TRAITS(kMuons, kMuonMass, 0, 0)
+// Electrons and positrons are stored together and count equally
+CONVENIENT_SPECIES_TRAITS(kElectrons, 0.000511, 1, 0)
+CONVENIENT_SPECIES_TRAITS(kTaus, 1.77686, 0, 0)
+CONVENIENT_SPECIES_TRAITS(kNus, 0, 0, 0)
+#undef CONVENIENT_SPECIES_TRAITS
+// kOthers has no traits, since its particles differ. Use the functions
+// that take the PDG codes instead.
+
+// The particles of one species copied out of a ParticleView into
+// contiguous arrays. The arrays are reused from event to event, so keep
+// one ParticleBatch per species outside the event loop.
+struct ParticleBatch {
+	int n = 0;
+	std::vector<float> E;
+	std::vector<float> px;
+	std::vector<float> py;
+	std::vector<float> pz;
+	std::vector<int> pdg; // Only filled for kOthers
+
+	void Load(const ParticleView& view, bool load_pdg = false) {
+		n = view.size();
+		if((int) E.size() < n) {
+			E.resize(n);
+			px.resize(n);
+			py.resize(n);
+			pz.resize(n);
+			pdg.resize(n);
+		}
+		for(int i = 0; i < n; i++) {
+			E[i] = view.E(i);
+			px[i] = view.px(i);
+			py[i] = view.py(i);
+			pz[i] = view.pz(i);
+		}
+		if(load_pdg) {
+			for(int i = 0; i < n; i++) pdg[i] = view.pdg(i);
+		}
+	}
+};
+
+namespace kinematics {
+
+// Single particles
+
+inline float Momentum(float px, float py, float pz) {
+	return std::sqrt(px * px + py * py + pz * pz);
+}
+
+// cos of the angle to z. A particle at rest counts as along z, as for
+// TVector3::Theta.
+inline float CosTheta(float px, float py, float pz) {
+	float p = Momentum(px, py, pz);
+	return (p > 0) ? pz / p : 1;
+}
+
+inline float Theta(float px, float py, float pz) {
+	return std::atan2(std::sqrt(px * px + py * py), pz);
+}
+
+// Like calcMass in xsec_analysis_macro.C, this is NaN for particles with
+// E < |p|
+inline float InvariantMass(float E, float px, float py, float pz) {
+	return std::sqrt(E * E - (px * px + py * py + pz * pz));
+}
+
+// The 4-momentum transfer squared, Q2 = -(k - k')^2, from a neutrino of
+// energy Enu along z to a lepton with 4-momentum (E, px, py, pz)
+inline float Q2(float Enu, float E, float px, float py, float pz) {
+	float q0 = Enu - E;
+	float qz = Enu - pz;
+	return px * px + py * py + qz * qz - q0 * q0;
+}
+
+// Batches. out must hold n floats, and may not alias the inputs.
+
+inline void Momentum(const float* px, const float* py, const float* pz, \
+	int n, float* out) {
+	for(int i = 0; i < n; i++) {
+		out[i] = std::sqrt(px[i] * px[i] + py[i] * py[i] + pz[i] * pz[i]);
+	}
+}
+
+inline void CosTheta(const float* px, const float* py, const float* pz, \
+	int n, float* out) {
+	for(int i = 0; i < n; i++) {
+		float p = std::sqrt(px[i] * px[i] + py[i] * py[i] + pz[i] * pz[i]);
+		out[i] = (p > 0) ? pz[i] / p : 1;
+	}
+}
+
+inline void Theta(const float* px, const float* py, const float* pz, \
+	int n, float* out) {
+	for(int i = 0; i < n; i++) {
+		out[i] = std::atan2(std::sqrt(px[i] * px[i] + py[i] * py[i]), pz[i]);
+	}
+}
+
+inline void KineticEnergy(const float* E, float mass, int n, float* out) {
+	for(int i = 0; i < n; i++) out[i] = E[i] - mass;
+}
+
+template <int S>
+inline void KineticEnergy(const float* E, int n, float* out) {
+	KineticEnergy(E, SpeciesTraits<S>::Mass(), n, out);
+}
+
+inline void InvariantMass(const float* E, const float* px, const float* py, \
+	const float* pz, int n, float* out) {
+	for(int i = 0; i < n; i++) {
+		out[i] = std::sqrt(E[i] * E[i] - \
+			(px[i] * px[i] + py[i] * py[i] + pz[i] * pz[i]));
+	}
+}
+
+// Q2 for each of a batch of leptons, all from a neutrino of energy Enu
+inline void Q2(float Enu, const float* E, const float* px, const float* py, \
+	const float* pz, int n, float* out) {
+	for(int i = 0; i < n; i++) {
+		float q0 = Enu - E[i];
+		float qz = Enu - pz[i];
+		out[i] = px[i] * px[i] + py[i] * py[i] + qz * qz - q0 * q0;
+	}
+}
+
+// The total contribution of n particles of species S to the available
+// energy. For every species it is linear in the energies, so this is a
+// plain sum.
+template <int S>
+inline float Eavail(const float* E, int n) {
+	if(SpeciesTraits<S>::EavailScale() == 0) {
+		return n * SpeciesTraits<S>::EavailOffset();
+	}
+	float sum = 0;
+	for(int i = 0; i < n; i++) sum += E[i];
+	return SpeciesTraits<S>::EavailScale() * sum + \
+		n * SpeciesTraits<S>::EavailOffset();
+}
+
+// The same for particles of mixed species, such as kOthers
+inline float Eavail(const float* E, const int* pdg, int n) {
+	float sum = 0;
+	for(int i = 0; i < n; i++) sum += EavailContribution(pdg[i], E[i]);
+	return sum;
+}
+
+} // namespace kinematics
+
+} // namespace convenient
+
+#endif // CONVENIENT_KINEMATICS_H
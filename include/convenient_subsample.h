@@ -0,0 +1,208 @@
+// Author: Colin Weber (webe1077@umn.edu)
+// Date: 16 October 2026
+// Purpose: To pick a small subsample of a CONVENIENT file whose weighted
+// histograms are unbiased estimates of those of the whole file, for quick
+// looks at a sample (e.g. tuning cuts or checking a binning) before the
+// final pass over all of it.
+//
+// The events are sorted into strata by neutrino PDG code, CC or NC,
+// interaction type (NEUT_int_type, or Mode for GiBUU), and the bin of
+// FlatTree_FLUX their neutrino energy falls in. Each event of a stratum is
+// kept with the same probability, the requested fraction, raised for small
+// strata so that each keeps about min_per_stratum events (or all of them),
+// and every kept event is weighted by 1 / that probability. Rare channels
+// and energies therefore stay in the subsample, and every histogram is
+// unbiased whatever it selects. Whether an event is kept only depends on
+// the seed and its entry, so the subsample is reproducible.
+//
+// The price is a larger statistical uncertainty. An event kept with
+// probability p carries 1 / p times the variance, so the uncertainty of a
+// bin grows by the square root of sum(w^2 / p) / sum(w^2) over its
+// events. ErrorInflation gives this for the whole file, and
+// MaxErrorInflation for the worst stratum.
+//
+// Command: #include "convenient_subsample.h"
+// Usually used through convenient::AnalysisEngine::SetSubsample (see
+// convenient_analysis.h), or NUISANCE/make_convenient_subsample.C, which
+// writes the subsample to a file. By hand:
+// 	convenient::StratifiedSubsample subsample(0.05);
+// 	subsample.Select(file);
+// 	subsample.Print();
+// 	convenient::Reader reader(file);
+// 	for(size_t i = 0; i < subsample.Entries().size(); i++) {
+// 		reader.SetEntry(subsample.Entries()[i]);
+// 		reader.SetEntryScale(subsample.Scales()[i]);
+// 		h->Fill(reader.Enu(), reader.Weight());
+// 	}
+
+#ifndef CONVENIENT_SUBSAMPLE_H
+#define CONVENIENT_SUBSAMPLE_H
+
+// Includes
+// ROOT includes
+#include "TFile.h"
+#include "TH1.h"
+
+// CONVENIENT includes
+#include "convenient_bootstrap.h" // For MixBits
+#include "convenient_format.h" // For reading the files
+
+// C++ includes
+#include <algorithm>
+#include <array>
+#include <cmath> // For std::sqrt
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace convenient {
+
+// The number of events each stratum keeps at least, if it has them. Large
+// enough that the histograms of a stratum are not just a few heavy events.
+const Long64_t kDefaultMinPerStratum = 100;
+
+class StratifiedSubsample {
+ public:
+	explicit StratifiedSubsample(double fraction = 1, uint64_t seed = 0, \
+		Long64_t min_per_stratum = kDefaultMinPerStratum) : \
+		fFraction(fraction), fSeed(seed), fMinPerStratum(min_per_stratum) {
+		if(fFraction > 1) fFraction = 1;
+		if(fMinPerStratum < 0) fMinPerStratum = 0;
+	}
+
+	double Fraction() const { return fFraction; }
+	// Whether there is anything to subsample
+	bool Active() const { return fFraction > 0 && fFraction < 1; }
+
+	// Sorts the events of file into strata and picks the subsample. Only
+	// the branches the strata and the weights need are read. Returns false
+	// if the file has no CONVENIENT tree.
+	bool Select(TFile* file) {
+		fEntries.clear();
+		fScales.clear();
+		fStrata.clear();
+		fNEntries = 0;
+		TTree* tree = (TTree*) file->Get(kTreeName);
+		if(!tree) return false;
+		TH1D* flux = (TH1D*) file->Get(kFluxName);
+
+		// The stratum of every entry
+		std::map<std::array<int, 4>, int> ids;
+		std::vector<int> stratum_of;
+		stratum_of.reserve(tree->GetEntries());
+		Reader reader(file);
+		while(reader.Next()) {
+			std::array<int, 4> key = {reader.PDGnu(), \
+				reader.flagCC() ? 1 : (reader.flagNC() ? 2 : 0), \
+				reader.IntType(), flux ? flux->FindFixBin(reader.Enu()) : 0};
+			auto found = ids.find(key);
+			if(found == ids.end()) {
+				found = ids.emplace(key, fStrata.size()).first;
+				fStrata.push_back(Stratum());
+				fStrata.back().key = key;
+			}
+			Stratum& stratum = fStrata[found->second];
+			double weight = reader.Weight();
+			stratum.n_entries++;
+			stratum.sum_w2 += weight * weight;
+			stratum_of.push_back(found->second);
+		}
+		fNEntries = stratum_of.size();
+
+		// The probability with which the events of each stratum are kept
+		for(Stratum& stratum : fStrata) {
+			stratum.probability = 1;
+			if(!Active() || stratum.n_entries <= fMinPerStratum) continue;
+			stratum.probability = std::max(fFraction, \
+				(double) fMinPerStratum / stratum.n_entries);
+		}
+
+		// Keep each event if a hash of its entry falls below the
+		// probability of its stratum
+		for(Long64_t i = 0; i < fNEntries; i++) {
+			Stratum& stratum = fStrata[stratum_of[i]];
+			if(stratum.probability < 1) {
+				// The top 53 bits, as a uniform number in [0, 1)
+				double u = (MixBits(MixBits(fSeed) ^ MixBits(i)) >> 11) / \
+					9007199254740992.;
+				if(u >= stratum.probability) continue;
+			}
+			fEntries.push_back(i);
+			fScales.push_back(1. / stratum.probability);
+			stratum.n_kept++;
+		}
+		return true;
+	}
+
+	// The kept entries, in increasing order, and the factor by which the
+	// weight of each is multiplied
+	const std::vector<Long64_t>& Entries() const { return fEntries; }
+	const std::vector<double>& Scales() const { return fScales; }
+	Long64_t NEntries() const { return fNEntries; }
+	size_t NStrata() const { return fStrata.size(); }
+
+	// The expected factor by which the statistical uncertainty of the
+	// whole file grows
+	double ErrorInflation() const {
+		double full = 0;
+		double subsample = 0;
+		for(const Stratum& stratum : fStrata) {
+			full += stratum.sum_w2;
+			subsample += stratum.sum_w2 / stratum.probability;
+		}
+		return full > 0 ? std::sqrt(subsample / full) : 1;
+	}
+
+	// The expected factor by which the statistical uncertainty of the
+	// stratum that is subsampled the most grows
+	double MaxErrorInflation() const {
+		double inflation = 1;
+		for(const Stratum& stratum : fStrata) {
+			inflation = std::max(inflation, 1 / std::sqrt(stratum.probability));
+		}
+		return inflation;
+	}
+
+	// Describes the subsample for the cache of the analysis engine
+	std::string Definition() const {
+		if(!Active()) return "";
+		std::ostringstream definition;
+		definition.precision(17);
+		definition << "subsample " << fFraction << " " << fSeed << " " << \
+			fMinPerStratum;
+		return definition.str();
+	}
+
+	void Print(std::ostream& out = std::cout) const {
+		out << "Kept " << fEntries.size() << " of " << fNEntries << \
+			" entries in " << fStrata.size() << " strata. Statistical " << \
+			"uncertainties grow by " << ErrorInflation() << " overall, and " << \
+			"by up to " << MaxErrorInflation() << " in a stratum.\n";
+	}
+
+ private:
+	// The events with one neutrino, current, interaction type, and energy
+	// bin
+	struct Stratum {
+		std::array<int, 4> key;
+		Long64_t n_entries = 0;
+		Long64_t n_kept = 0;
+		double sum_w2 = 0;
+		double probability = 1;
+	};
+
+	double fFraction;
+	uint64_t fSeed;
+	Long64_t fMinPerStratum;
+	Long64_t fNEntries = 0;
+	std::vector<Stratum> fStrata;
+	std::vector<Long64_t> fEntries;
+	std::vector<double> fScales;
+};
+
+} // namespace convenient
+
+#endif // CONVENIENT_SUBSAMPLE_H
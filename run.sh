@@ -4,7 +4,9 @@
 # It takes as input the number of events, neutrino energy spectra and 
 # flavors, target composition, seed, and a list of event generators to run, 
 # then runs the generators and processes the outputs, putting them in a 
-# useful format.
+# useful format. The runs are independent, so they are run concurrently, 
+# each in its own working directory under $CONVENIENT_WORK_DIR, as many at 
+# a time as the core budget set in set_run_variables.sh allows.
 
 # Command: source run.sh
 # Note that in novasoft, source must be the command we use to execute the 
@@ -23,6 +25,12 @@
 # Outputs
 # -------
 #	A set of CONVENIENT files depending on the run variables, with a .txt file corresponding to each CONVENIENT file describing how the file was created. 
+#	$CONVENIENT_WORK_DIR/$DATE/logs
+#		The output of each run, and its exit status
+#	$CONVENIENT_DIR/ConvenientTelemetry.tsv
+#		The time, CPU, memory, and I/O of each stage of each run (see 
+#		documentation_generation_scripts/telemetry.sh), which are also 
+#		listed in the .txt file of each output
 
 # She-bang!
 #!/bin/bash
@@ -30,6 +38,9 @@
 # Tell us we've begun
 echo "Convenient run begun."
 
+# For recording how long each stage takes (see telemetry.sh)
+source $CONVENIENT_DIR/documentation_generation_scripts/telemetry.sh
+
 ## Figure out which generators to run, and with which configurations/tunes
 echo "Parsing generator list..."
 
@@ -45,6 +56,7 @@ flux_file_name_list=''
 flux_histo_list=''
 seed_list=''
 target_list=''
+write_policy_list=''
 
 read -a runs <<< "$RUNS"
 for run in "${runs[@]}" # For each run
@@ -79,6 +91,11 @@ for Target in "${targets[@]}"
 do
 	target_list+="$Target "
 done
+read -a write_policies <<< "$WRITE_POLICIES"
+for write_policy in "${write_policies[@]}"
+do
+	write_policy_list+="$write_policy "
+done
 IFS=' '
 echo "Run variables parsed."
 
@@ -97,6 +114,8 @@ read -a seed_array <<< $seed_list
 
 read -a target_array <<< $target_list
 
+read -a write_policy_array <<< $write_policy_list
+
 # Check that all these strings are of equal length
 lengths=(${#config_array[@]} ${#flux_array[@]} ${#flux_file_name_array[@]} ${#flux_histo_array[@]} ${#seed_array[@]} ${#target_array[@]})
 for i in "${lengths[@]:1}"; do
@@ -108,9 +127,29 @@ for i in "${lengths[@]:1}"; do
 	fi
 done
 
-# Loop through the generators and configurations
-for ((j=0; j<${#generator_array[@]}; j++))
-do
+# WRITE_POLICIES is either one policy for every run, or one per run
+if [ ${#write_policy_array[@]} -gt 1 ] && \
+	[ ${#write_policy_array[@]} != ${lengths[0]} ];
+then
+	echo "WRITE_POLICIES must be a single policy or have one per run."
+	exit 1
+fi
+
+# The write policy of entry j of the lists
+# Format is entry_write_policy j
+entry_write_policy() {
+	if [ ${#write_policy_array[@]} -gt 1 ];
+	then
+		echo ${write_policy_array[$1]}
+	else
+		echo ${write_policy_array[0]:-default}
+	fi
+}
+
+# Set the inputs of entry j of the lists
+load_entry() {
+	j=$1
+
 	# Grab the generator and configuration
 	generator=${generator_array[$j]}
 	config=${config_array[$j]}
@@ -125,170 +164,125 @@ do
 
 	Target=$CONVENIENT_TAR_DIR/${target_array[$j]}
 
+	# The converters read the write policy from the environment
+	export CONVENIENT_WRITE_POLICY=$(entry_write_policy $j)
+
+	# The directory holding the working directories of the entry
+	entry_dir=$CONVENIENT_WORK_DIR/$DATE/run_${j}_${generator}_${seed}
+
+	# What the stages of the entry are recorded under (see telemetry.sh). 
+	# The last field is the shard, which run_shard sets.
+	export CONVENIENT_TELEMETRY_CONTEXT="$DATE	$j	$generator	$config	$seed	-"
+}
+
+# Find the outputs of entry j that already exist, using the catalog of all 
+# the outputs (see documentation_generation_scripts/query_catalog.sh). The 
+# entry is described the way the conveniently_run_*.sh scripts describe 
+# its output. The generator version isn't known until the generator has 
+# been set up, but it is fixed by the generator and tune. Prints the path 
+# of each output found.
+# Format is find_existing_output j
+find_existing_output() {
+	local generator=${generator_array[$1]}
+	local tune=${config_array[$1]#*/}
+	local target=${target_array[$1]}
+	local flavor=$FLAVOR
+	local nova_switch
+	case $generator in
+		NuWro) tune=${tune%.txt} ;;
+		NEUT) tune=${tune%.card} ;;
+		GiBUU)
+			tune=${tune%.job}
+			flavor=$FLAVOR$GIBUU_CC_NC
+			;;
+	esac
+	if [ "${target:0:4}" == "NOvA" ];
+	then
+		nova_switch=1
+		if [ $generator == "NEUT" ];
+		then
+			target=${target/GENIE/NEUT}
+		fi
+	else
+		nova_switch=0
+		target=${target#*elements/}
+		target=${target%.txt}
+	fi
+	bash $CONVENIENT_DIR/documentation_generation_scripts/query_catalog.sh \
+		--generator $generator --tune $tune --flux $HC${flux_array[$1]} \
+		--flux_file ${flux_file_name_array[$1]} \
+		--flux_histo ${flux_histo_array[$1]} \
+		--flavor $flavor --target $target --seed ${seed_array[$1]} \
+		--n_events $N_EVENTS --nova_switch $nova_switch \
+		--write_policy $(entry_write_policy $1) --existing --paths
+}
+
+# Give a run its own working directory, holding a copy of the generator's 
+# directory, and move into it. The generator scripts write their temporary 
+# files (and edit their parameter files) in the current directory, so this 
+# is what lets several runs go at once. The flux caches in beam_energies 
+# are shared, and linked rather than copied.
+# Format is setup_workdir workdir
+setup_workdir() {
+	workdir=$1
+	rm -rf $workdir
+	mkdir -p $workdir
+	for item in $CONVENIENT_DIR/$generator/*
+	do
+		if [ "${item##*/}" == "beam_energies" ];
+		then
+			ln -s $item $workdir/beam_energies
+		else
+			cp -a $item $workdir/
+		fi
+	done
+	cd $workdir
+
+	# Keep the run to its share of the cores
+	export OMP_NUM_THREADS=$CORES_PER_RUN
+}
+
+# Generate and process the events of the current entry with the 
+# generator's wrapper. The wrapper sets convenient_output_dir, filepath, 
+# filename_convenient, and nova_switch. This sets the generator version, 
+# neutrino and target to document the output with.
+generate_entry() {
 	# Depending on the generator, execute the appropriate commands
 	case $generator in
 		GENIE)
-			cd GENIE
 			source conveniently_run_genie.sh \
 				--config $config --flux_file $flux_file \
 				--flux_histo $flux_histo --seed $seed --target $Target
-			cd ../
-
-			# Write the accompanying text file describing the inputs of the 
-			# new file. All inputs refer to the values that were used to 
-			# create the output.
-			# Format is
-			# -l filepath,convenient filename -n number of events 
-			# -h horn current polarity (caps) -p neutrino pdg 
-			# -f flux file,flux histogram
-			# -t path to file containing target composition in GENIE form
-			# -d date in yyyymmddhhmmss format -v generator version 
-			# --seed MC seed
-			echo "Generating output .txt file..."
-			bash documentation_generation_scripts/create_output_txt_file.sh \
-				-l $convenient_output_dir/$filepath,$filename_convenient \
-				-n $N_EVENTS \
-				-h $HC \
-				-p $NEUTRINO_PDG \
-				-f $flux_file,$flux_histo \
-				-t $Target \
-				-d $DATE \
-				-v $generator_version \
-				--seed $seed
-			echo "Output .txt file generated."
-			# Add the run to the data list using add_to_data_list.sh
-			# Format is 
-			# -g generator -t tune/parameter file -f filename --flux flux
-			# --nova_switch 1=used ND element weights
-			echo "Adding run to data list..."
-			bash documentation_generation_scripts/add_to_data_list.sh \
-				-g GENIE -t ${generator_version}_${config} \
-				-f $filename_convenient \
-				--flux $flux --nova_switch $nova_switch
-			echo "Run added to data list."	
+			version=$generator_version
+			doc_pdg=$NEUTRINO_PDG
+			doc_target=$Target
 			;;
 
 		NuWro)
-			cd NuWro
 			source conveniently_run_nuwro.sh \
 				--config $config --flux_file $flux_file \
 				--flux_histo $flux_histo --seed $seed --target $Target
-			cd ../
-			
-			# Write the accompanying text file describing the inputs of the 
-			# new file. All inputs refer to the values that were used to 
-			# create the output.
-			# Format is
-			# -l filepath,convenient filename -n number of events 
-			# -h horn current polarity (caps) -p neutrino pdg 
-			# -f flux file,flux histogram
-			# -t path to file containing target composition in GENIE form
-			# -d date in yyyymmddhhmmss format -v generator version 
-			# --seed MC seed
-			echo "Creating output .txt file..."
-			bash documentation_generation_scripts/create_output_txt_file.sh \
-				-l $convenient_output_dir/$filepath,$filename_convenient \
-				-n $N_EVENTS \
-				-h $HC \
-				-p $NEUTRINO_PDG \
-				-f $flux_file,$flux_histo \
-				-t $Target \
-				-d $DATE \
-				-v $NUWRO_VERSION \
-				--seed $seed
-			echo "Output .txt file created."
-			# Add the run to the data list using add_to_data_list.sh
-			# Format is 
-			# -g generator -t tune/parameter file -f filename --flux flux
-			# --nova_switch 1=used ND element weights
-			echo "Adding run to data list..."
-			bash documentation_generation_scripts/add_to_data_list.sh \
-				-g NuWro -t ${NUWRO_VERSION}_${config} \
-				-f $filename_convenient \
-				--flux $flux --nova_switch $nova_switch
-			echo "Run added to data list."
+			version=$NUWRO_VERSION
+			doc_pdg=$NEUTRINO_PDG
+			doc_target=$Target
 			;;
 
 		NEUT)
-			cd NEUT
 			source conveniently_run_neut.sh \
 				--config $config --flux_file $flux_file \
 				--flux_histo $flux_histo --seed $seed --target $Target
-			cd ../	
-			
-			# Write the accompanying text file describing the inputs of the 
-			# new file. All inputs refer to the values that were used to 
-			# create the output.
-			# Format is
-			# -l filepath,convenient filename -n number of events 
-			# -h horn current polarity (caps) -p neutrino pdg 
-			# -f flux file,flux histogram
-			# -t path to file containing target composition in GENIE form
-			# -d date in yyyymmddhhmmss format -v generator version 
-			# --seed MC seed
-			echo "Creating output .txt file..."
-			bash documentation_generation_scripts/create_output_txt_file.sh \
-				-l $convenient_output_dir/$filepath,$filename_convenient \
-				-n $N_EVENTS \
-				-h $HC \
-				-p $NEUTRINO_PDG \
-				-f $flux_file,$flux_histo \
-				-t $neut_target \
-				-d $DATE \
-				-v $NEUT_VERSION \
-				--seed $seed
-			echo "Output .txt file created."
-			# Add the run to the data list using add_to_data_list.sh
-			# Format is 
-			# -g generator -t tune/parameter file -f filename --flux flux
-			# --nova_switch 1=used ND element weights
-			echo "Adding run to data list..."
-			bash documentation_generation_scripts/add_to_data_list.sh \
-				-g $generator -t ${NEUT_VERSION}_${config} \
-				-f $filename_convenient \
-				--flux $flux --nova_switch $nova_switch
-			echo "Run added to data list."
+			version=$NEUT_VERSION
+			doc_pdg=$NEUTRINO_PDG
+			doc_target=$neut_target
 			;;
 
 		GiBUU)
-			cd GiBUU
 			source conveniently_run_gibuu.sh \
 				--config $config --flux_file $flux_file \
 				--flux_histo $flux_histo --seed $seed --target $Target
-			cd ../	
-	
-			# Write the accompanying text file describing the inputs of the 
-			# new file. All inputs refer to the values that were used to 
-			# create the output.
-			# Format is
-			# -l filepath,convenient filename -n number of events 
-			# -h horn current polarity (caps) -p neutrino pdg 
-			# -f flux file,flux histogram
-			# -t path to file containing target composition in GENIE form
-			# -d date in yyyymmddhhmmss format -v generator version 
-			# --seed MC seed
-			echo "Creating output .txt file..."
-			bash documentation_generation_scripts/create_output_txt_file.sh \
-				-l $convenient_output_dir/$filepath,$filename_convenient \
-				-n $N_EVENTS \
-				-h $HC \
-				-p $NEUTRINO_PDG,$GIBUU_CC_NC \
-				-f $flux_file,$flux_histo \
-				-t $gibuu_target \
-				-d $DATE \
-				-v $GiBUU_VERSION \
-				--seed $seed
-			echo "Output .txt file created."
-			# Add the run to the data list using add_to_data_list.sh
-			# Format is 
-			# -g generator -t tune/parameter file -f filename --flux flux
-			# --nova_switch 1=used ND element weights
-			echo "Adding run to data list..."
-			bash documentation_generation_scripts/add_to_data_list.sh \
-				-g $generator -t ${GiBUU_VERSION}_${config} \
-				-f $filename_convenient \
-				--flux $flux --nova_switch $nova_switch
-			echo "Run added to data list."
+			version=$GiBUU_VERSION
+			doc_pdg=$NEUTRINO_PDG,$GIBUU_CC_NC
+			doc_target=$gibuu_target
 			;;
 
 		*)
@@ -296,7 +290,362 @@ do
 			exit 1
 			;;
 	esac
+}
+
+# Document a Convenient file of the current entry
+# Format is document_output directory filename target nova_switch
+document_output() {
+	# Write the accompanying text file describing the inputs of the 
+	# new file. All inputs refer to the values that were used to 
+	# create the output.
+	# Format is
+	# -l filepath,convenient filename -n number of events 
+	# -h horn current polarity (caps) -p neutrino pdg 
+	# -f flux file,flux histogram
+	# -t path to file containing target composition in GENIE form
+	# -d date in yyyymmddhhmmss format -v generator version 
+	# --seed MC seed --telemetry stages of the entry
+	echo "Creating output .txt file..."
+	bash $CONVENIENT_DIR/documentation_generation_scripts/create_output_txt_file.sh \
+		-l $1,$2 \
+		-n $N_EVENTS \
+		-h $HC \
+		-p $doc_pdg \
+		-f $flux_file,$flux_histo \
+		-t $3 \
+		-d $DATE \
+		-v $version \
+		--seed $seed \
+		--telemetry "$CONVENIENT_TELEMETRY_FILE"
+	echo "Output .txt file created."
+	# Add the run to the data list using add_to_data_list.sh
+	# Format is 
+	# -g generator -t tune/parameter file -f filename --flux flux
+	# --nova_switch 1=used ND element weights
+	echo "Adding run to data list..."
+	bash $CONVENIENT_DIR/documentation_generation_scripts/add_to_data_list.sh \
+		-g $generator -t ${version}_${config} \
+		-f $2 \
+		--flux $flux --nova_switch $4
+	echo "Run added to data list."
+}
+
+# Run entry j of the lists in one go. This is run in its own subshell, so 
+# that the environment set up for one generator (e.g. the GENIE version) 
+# doesn't leak into the other runs.
+run_entry() {
+	load_entry $1
+	setup_workdir $entry_dir
+
+	# The working directory is only kept if the run failed, for debugging. 
+	# A file left at the output path by an earlier run doesn't make a 
+	# failed run a success, so the status of the wrapper is checked too.
+	generate_entry
+	local status=$?
+	cd $CONVENIENT_DIR
+	if [ $status -ne 0 ] || \
+		[ ! -f "$convenient_output_dir/$filepath/$filename_convenient" ];
+	then
+		echo "Error: $filename_convenient was not created. Keeping $workdir."
+		return 1
+	fi
+	document_output $convenient_output_dir/$filepath $filename_convenient \
+		$doc_target $nova_switch
+	rm -rf $workdir
+}
+
+# Run shard k of entry j. The shard generates its share of the events with 
+# its own seed, derived from the seed of the entry, and keeps all its 
+# outputs in its working directory until merge_entry combines them. The 
+# generator wrappers read the share and the seed from CONVENIENT_SHARD_EVENTS 
+# and CONVENIENT_SHARD_SEED, and fall back to N_EVENTS and the seed of the 
+# entry when these are unset. Files are named after the whole entry, so 
+# every shard produces the same names.
+run_shard() {
+	load_entry $1
+	k=$2
+	export CONVENIENT_SHARD=$k
+	export CONVENIENT_TELEMETRY_CONTEXT="${CONVENIENT_TELEMETRY_CONTEXT%	*}	$k"
+	export CONVENIENT_SHARD_SEED=$(( $seed * 1000 + $k ))
+	export CONVENIENT_SHARD_EVENTS=$(( $N_EVENTS / $N_SHARDS ))
+	if [ $k -lt $(( $N_EVENTS % $N_SHARDS )) ];
+	then
+		CONVENIENT_SHARD_EVENTS=$(( $CONVENIENT_SHARD_EVENTS + 1 ))
+	fi
+	echo "Shard $k of run $j: $CONVENIENT_SHARD_EVENTS events with seed $CONVENIENT_SHARD_SEED."
+
+	# Send the outputs of the wrapper to the working directory of the shard
+	setup_workdir $entry_dir/shard_$k
+	shard_out=$workdir/out
+	export CONVENIENT_OUTPUT_DIR=$shard_out/convenient
+	export CONVENIENT_NOvA_OUTPUT_DIR=$shard_out/convenient_nova
+	export CONVENIENT_NUISANCE_OUTPUT_DIR=$shard_out/nuisance
+	export CONVENIENT_NUISANCE_NOvA_OUTPUT_DIR=$shard_out/nuisance_nova
+	generate_entry
+	local status=$?
+	cd $CONVENIENT_DIR
+	if [ $status -ne 0 ] || \
+		[ ! -f "$convenient_output_dir/$filepath/$filename_convenient" ];
+	then
+		echo "Error: $filename_convenient was not created."
+		return 1
+	fi
+
+	# Record what merge_entry needs to document the merged output
+	if [ $k -eq 0 ];
+	then
+		main_file=${convenient_output_dir#$shard_out/}/$filepath/$filename_convenient
+		declare -p version doc_pdg doc_target nova_switch filepath main_file > \
+			$entry_dir/shard_record.sh
+	fi
+}
+
+# Combine the shards of entry j. The Convenient files of the shards are 
+# merged as runs of one configuration (see make_convenient_from_convenient.C), 
+# which normalizes them like a single run with all the events. The composite 
+# of a mixed target is merged the same way, element by element, since the 
+# generator scale factors of its elements differ. The NUISANCE files are 
+# kept as they are, one per shard.
+merge_entry() {
+	load_entry $1
+	source $entry_dir/shard_record.sh
+	echo "Merging the $N_SHARDS shards of run $j..."
+
+	# The stages of the shards belong to the merged output too
+	local shard_telemetry
+	for shard_telemetry in $log_dir/run_${j}_${generator}_${seed}.shard*.telemetry.tsv
+	do
+		grep -hv '^#' "$shard_telemetry" >> $CONVENIENT_TELEMETRY_FILE 2> /dev/null
+	done
+	cd $entry_dir/shard_0/out
+	while IFS= read -r file
+	do
+		file=${file#./}
+		kind=${file%%/*}
+		rel=${file#*/}
+		case $kind in
+			convenient) out_dir=$CONVENIENT_OUTPUT_DIR ;;
+			convenient_nova) out_dir=$CONVENIENT_NOvA_OUTPUT_DIR ;;
+			nuisance) out_dir=$CONVENIENT_NUISANCE_OUTPUT_DIR ;;
+			nuisance_nova) out_dir=$CONVENIENT_NUISANCE_NOvA_OUTPUT_DIR ;;
+		esac
+		mkdir -p $out_dir/${rel%/*}
+		if [ ${kind%_nova} == "nuisance" ];
+		then
+			for ((k=0; k<$N_SHARDS; k++))
+			do
+				timed_stage -n 0 move mv "$entry_dir/shard_$k/out/$file" \
+					"$out_dir/${rel%.root}.shard$k.root" || return 1
+			done
+			continue
+		fi
+		inputs=""
+		for ((k=0; k<$N_SHARDS; k++))
+		do
+			inputs+="$entry_dir/shard_$k/out/$file "
+		done
+		# The merge is written to a temporary name and only renamed once it 
+		# has succeeded, so that neither a partial merge nor an earlier 
+		# output is taken for it
+		merged="$out_dir/${rel%.root}.merging.root"
+		rm -f "$merged"
+		if ! timed_stage merge root -q "$CONVENIENT_NUISANCE_DIR/make_convenient_from_convenient.C(\"${inputs% }\", \"$merged\", \"runs\")" || \
+			[ ! -f "$merged" ];
+		then
+			rm -f "$merged"
+			echo "Error: could not merge the shards of $rel. Keeping $entry_dir."
+			return 1
+		fi
+		mv "$merged" "$out_dir/$rel" || return 1
+
+		# Document the merged file. The unweighted elemental files of a 
+		# mixed target are documented like single-element runs, with the 
+		# element given by their directory.
+		if [ "$file" == "$main_file" ];
+		then
+			document_output $out_dir/$filepath ${rel##*/} $doc_target \
+				$nova_switch
+		elif [ $kind == "convenient" ];
+		then
+			element_dir=${rel%/*}
+			document_output $out_dir/$element_dir ${rel##*/} \
+				${element_dir##*/} 0
+		fi
+	done <<< "$(find . -name "*.root")"
+	cd $CONVENIENT_DIR
+	rm -rf $entry_dir
+	echo "Run $j merged."
+}
+
+## Run the entries concurrently
+# The number of runs to have going at once is limited both by MAX_JOBS and 
+# by the number of cores each run gets out of the core budget
+max_jobs=$(( ${CORE_BUDGET:-1} / ${CORES_PER_RUN:-1} ))
+if [ $max_jobs -lt 1 ];
+then
+	max_jobs=1
+fi
+if [ -n "$MAX_JOBS" ] && [ $MAX_JOBS -lt $max_jobs ];
+then
+	max_jobs=$MAX_JOBS
+fi
+N_SHARDS=${N_SHARDS:-1}
+if [ $N_SHARDS -lt 1 ] || [ $N_SHARDS -gt 999 ];
+then
+	echo "N_SHARDS must be between 1 and 999."
+	exit 1
+fi
+echo "Running ${#generator_array[@]} runs in $N_SHARDS shard(s) each, up to $max_jobs at a time."
+
+# Each job writes its output to its own log, since the output of 
+# concurrent jobs would be interleaved. Each job also leaves its exit 
+# status in a .status file next to its log.
+log_dir=$CONVENIENT_WORK_DIR/$DATE/logs
+mkdir -p $log_dir
+
+# Start a job in the background
+# Format is start_job log function arguments...
+start_job() {
+	local job_log=$1
+	shift
+	(
+		# The stages of the job are recorded next to its log
+		export CONVENIENT_TELEMETRY_FILE=$job_log.telemetry.tsv
+		echo "$telemetry_header" > $CONVENIENT_TELEMETRY_FILE
+		"$@"
+		echo $? > $job_log.status
+	) > $job_log.log 2>&1 &
+	echo "Started $* (log: $job_log.log)"
+}
+
+# Start the merge of every sharded entry whose shards have all finished
+merge_started=()
+start_ready_merges() {
+	local m k log status finished shard_failed
+	for ((m=0; m<${#generator_array[@]}; m++))
+	do
+		if [ -n "${merge_started[$m]}" ];
+		then
+			continue
+		fi
+		log=$log_dir/run_${m}_${generator_array[$m]}_${seed_array[$m]}
+		finished=1
+		shard_failed=0
+		for ((k=0; k<$N_SHARDS; k++))
+		do
+			status=$(cat $log.shard$k.status 2>/dev/null)
+			if [ -z "$status" ];
+			then
+				finished=0
+			elif [ "$status" != "0" ];
+			then
+				shard_failed=1
+			fi
+		done
+		if [ $finished -eq 0 ];
+		then
+			continue
+		fi
+		merge_started[$m]=1
+		if [ $shard_failed -eq 1 ];
+		then
+			echo "Not merging run $m, since one of its shards failed."
+			echo 1 > $log.status
+		else
+			start_job $log merge_entry $m
+		fi
+	done
+}
+
+# Skip the entries whose outputs already exist, either from an earlier 
+# Convenient run or from an earlier entry of the lists, unless 
+# REUSE_EXISTING is 0. A skipped entry counts as a success, and its 
+# outputs are reused as they are.
+skipped=()
+declare -A entry_keys
+for ((j=0; j<${#generator_array[@]}; j++))
+do
+	if [ "${REUSE_EXISTING:-1}" == "0" ];
+	then
+		break
+	fi
+	key="${generator_array[$j]} ${config_array[$j]} ${flux_array[$j]} ${flux_file_name_array[$j]} ${flux_histo_array[$j]} ${seed_array[$j]} ${target_array[$j]} $(entry_write_policy $j)"
+	existing=$(find_existing_output $j | head -n 1)
+	if [ -n "$existing" ];
+	then
+		skipped[$j]="already exists as $existing"
+	elif [ -n "${entry_keys[$key]}" ];
+	then
+		skipped[$j]="is the same as run ${entry_keys[$key]}"
+	else
+		entry_keys[$key]=$j
+		continue
+	fi
+	echo "Skipping run $j (${generator_array[$j]}:${config_array[$j]}, seed ${seed_array[$j]}), which ${skipped[$j]}."
+	log=$log_dir/run_${j}_${generator_array[$j]}_${seed_array[$j]}
+	echo 0 > $log.status
+	merge_started[$j]=1
+done
+
+# Start each job as soon as fewer than max_jobs are going. A run that is 
+# still converting its output then overlaps with the generation of the 
+# runs started after it. The merge of a sharded run starts as soon as its 
+# last shard is done.
+for ((j=0; j<${#generator_array[@]}; j++))
+do
+	if [ -n "${skipped[$j]}" ];
+	then
+		continue
+	fi
+	log=$log_dir/run_${j}_${generator_array[$j]}_${seed_array[$j]}
+	for ((k=0; k<$N_SHARDS; k++))
+	do
+		# The running jobs are polled, since wait -n, which would return 
+		# as soon as one finishes, needs bash 4.3, and SL7 has bash 4.2
+		while [ $(jobs -rp | wc -l) -ge $max_jobs ];
+		do
+			sleep 1
+			if [ $N_SHARDS -gt 1 ]; then start_ready_merges; fi
+		done
+		if [ $N_SHARDS -eq 1 ];
+		then
+			start_job $log run_entry $j
+		else
+			start_job $log.shard$k run_shard $j $k
+		fi
+	done
+done
+if [ $N_SHARDS -gt 1 ];
+then
+	while [ ${#merge_started[@]} -lt ${#generator_array[@]} ] && \
+		[ -n "$(jobs -rp)" ];
+	do
+		sleep 1
+		start_ready_merges
+	done
+	start_ready_merges
+fi
+wait
+
+# Report the runs that failed
+n_failed=0
+for ((j=0; j<${#generator_array[@]}; j++))
+do
+	log=$log_dir/run_${j}_${generator_array[$j]}_${seed_array[$j]}
+	if [ "$(cat $log.status 2>/dev/null)" != "0" ];
+	then
+		echo "Run $j failed! See $log*.log"
+		n_failed=$(($n_failed + 1))
+	fi
 done
+if [ $n_failed -gt 0 ];
+then
+	echo "$n_failed of ${#generator_array[@]} runs failed."
+fi
+if [ ${#skipped[@]} -gt 0 ];
+then
+	echo "${#skipped[@]} of ${#generator_array[@]} runs were skipped, since their outputs already existed (see above)."
+fi
 
 # Let us know we're done
 echo "Convenient run complete."
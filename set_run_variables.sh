@@ -53,6 +53,38 @@
 #		deterministic due to NuWro setting seed=0 and seed=1 to other 
 #		values. May be a comma-separated list.
 #
+#	CORE_BUDGET
+#		The number of cores that the runs may use in total. Defaults to all 
+#		the cores of the machine.
+#
+#	CORES_PER_RUN
+#		The number of cores given to each run. The generators run on a 
+#		single core, so this only needs to be raised for multithreaded 
+#		builds, or to let GiBUU and NEUT generate several elements of a 
+#		mixed target at once.
+#
+#	MAX_JOBS
+#		The most runs to have going at once. The number actually going at 
+#		once is the smaller of this and CORE_BUDGET / CORES_PER_RUN. Set it 
+#		to 1 to run one entry at a time.
+#
+#	N_SHARDS
+#		The number of shards to split each run into. Each shard generates 
+#		N_EVENTS / N_SHARDS events with its own seed (1000 * SEED + the 
+#		shard number), and the shards are merged into one Convenient file, 
+#		normalized like a single run of N_EVENTS events. Must be between 1 
+#		and 999. GiBUU shards split the GiBUU runs of the whole run instead, 
+#		so there must be at least N_SHARDS of those on every element.
+#
+#	REUSE_EXISTING
+#		Whether to skip the runs whose outputs already exist, according to 
+#		the catalog ConvenientCatalog.tsv (see 
+#		documentation_generation_scripts/query_catalog.sh). A run is 
+#		skipped if an output with the same generator, tune, flux, flux 
+#		file, flux histogram, flavor, target, seed, number of events, and 
+#		write policy still exists, or if it repeats an earlier run in the 
+#		lists. Set it to 0 to regenerate them anyway.
+#
 #	HC_lower
 #		The value of $HC but in lowercase. Is occasionally used throughout 
 #		CONVENIENT. It is set automatically.
@@ -110,6 +142,35 @@ export SEEDS="7,8,9,10,11"
 	# due to NuWro setting seed=0 and seed=1 to other values. May be a 
 	# comma-separated list.
 
+## Set output parameters ##
+export WRITE_POLICIES="default"
+	# How the Convenient outputs are written: one of default, analysis 
+	# (LZ4, fast to read), archive (ZSTD, or LZMA before ROOT 6.20, small), 
+	# or compact (archive, with the four-momenta kept to a relative 
+	# precision of 1.2e-4). A policy may be followed by :<bits> to keep 
+	# that many mantissa bits of the four-momenta, e.g. analysis:16. See 
+	# the write policies in include/convenient_format.h, and measure them 
+	# on a sample with NUISANCE/benchmark_write_policies.C. May be a 
+	# single policy for all the runs, or a comma-separated list with one 
+	# per run.
+
+## Set scheduling parameters ##
+export CORE_BUDGET=$(nproc)
+	# The number of cores that the runs may use in total
+
+export CORES_PER_RUN=1
+	# The number of cores given to each run
+
+export MAX_JOBS=$CORE_BUDGET
+	# The most runs to have going at once
+
+export N_SHARDS=1
+	# The number of shards to split each run into, so that one large run 
+	# can use several cores
+
+export REUSE_EXISTING=1
+	# Whether to skip the runs whose outputs already exist
+
 ## Nothing below this line should be changed.
 ## Use the above parameters to set other variables.
 case "$HC" in
@@ -11,6 +11,10 @@
 #		Assumes the current directory is the top-level CONVENIENT directory, 
 #		and assigns it to the variable.
 #
+#	ROOT_INCLUDE_PATH
+#		Prepends $CONVENIENT_DIR/include so that macros can include the 
+#		shared CONVENIENT headers (e.g. convenient_format.h).
+#
 # Sources
 # -------
 #	$CONVENIENT_DIR/global_vars.sh
@@ -41,3 +45,7 @@ echo "Setting up generators..."
 # automatically sets up, so first set up the correct ROOT version.
 setup root v6_22_08d -q e20:p392:prof
 source $CONVENIENT_DIR/setup_generators.sh
+
+# Make the shared CONVENIENT headers visible to ROOT macros. This is done 
+# after setting up ROOT so that the ROOT setup doesn't overwrite it.
+export ROOT_INCLUDE_PATH=$CONVENIENT_DIR/include${ROOT_INCLUDE_PATH:+:$ROOT_INCLUDE_PATH}
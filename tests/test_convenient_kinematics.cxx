@@ -0,0 +1,335 @@
+// Author: Colin Weber (webe1077@umn.edu)
+// Date: 16 October 2026
+// Purpose: To check that the batch kernels of convenient_kinematics.h give
+// the same results, particle by particle, as the single-particle functions
+// analyses used before them (calcTheta, calcMomentum, calcMass, and
+// addtoEavail, as first written in xsec_analysis_macro.C), so that
+// switching an analysis to the batches cannot change its histograms.
+// Theta, |p|, cos(theta), the invariant mass, Q2, and Eavail<S> for every
+// species with SpeciesTraits are compared on fixed particles (at rest,
+// along and against z, massless, off shell) and on random events of up to
+// 40 particles, including empty and one-particle events. The scalar
+// cos(theta) and Q2 of convenient_kinematics.h, which have no counterpart
+// in the macro, are compared with TVector3 and TLorentzVector in double
+// precision. The random numbers have a fixed seed, so every run checks the
+// same events.
+
+// Command: ctest (after building with cmake), or
+// 	<build directory>/bin/test_convenient_kinematics
+
+// Outputs
+// 	The exit status is 0 if every comparison passes, and 1 otherwise, in
+// 	which case the first mismatches are printed.
+
+// Includes
+// ROOT includes
+#include "TVector3.h" // For the double precision references
+#include "TLorentzVector.h"
+#include "TDatabasePDG.h" // For the masses of the single-particle functions
+#include "TParticlePDG.h"
+
+// CONVENIENT includes
+#include "convenient_kinematics.h"
+
+// C++ includes
+#include <cfloat> // For FLT_EPSILON
+#include <cmath>
+#include <cstdlib> // For abs
+#include <math.h>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// The single-particle functions and masses of xsec_analysis_macro.C, for
+// a particle given as (E, px, py, pz), copied as they were written there
+// before the batch kernels replaced them
+const float PIP_MASS = TDatabasePDG::Instance()->GetParticle(211)->Mass(); // GeV
+const float PROTON_MASS = TDatabasePDG::Instance()->GetParticle(2212)->Mass(); // GeV
+
+float calcTheta(std::vector<float> particle) {
+	TVector3 momentum(particle[1], particle[2], particle[3]);
+	return momentum.Theta();
+} 
+
+float calcKE(std::vector<float> particle, float mass) {
+	return particle[0] - mass;
+}
+
+float calcMomentum(std::vector<float> particle) {
+	TVector3 momentum(particle[1], particle[2], particle[3]);
+	return momentum.Mag();
+}
+
+float calcMass(std::vector<float> particle) {
+	float mass = sqrt(pow(particle[0], 2) - pow(calcMomentum(particle), 2));
+	return mass;
+}
+
+// addtoEavail is used to construct Eavail from the final state particle' 
+// 4-momenta. It follows the NOvA method implemented in 
+// CAFAna/Vars/TruthVars.cxx
+float addtoEavail(std::vector<float> particle, int PID) {
+	if (PID == 2212) {return calcKE(particle, PROTON_MASS);}
+	else if (abs(PID) == 211) {return calcKE(particle, PIP_MASS);}
+	else if ((PID == 111) || (PID == 11) || (PID == 22)) {
+		return particle[0];
+	}
+	else if (PID >= 2000000000) {return 0.0;}
+	else if (PID >= 1000000000) {return 0.0;}
+	else if (PID >= 2000 && PID != 2212 && PID != 2112) {
+		return particle[0] - PROTON_MASS;
+	}
+	else if (PID <= -2000) {
+		return particle[0] + PROTON_MASS;
+	}
+	else if (PID != 2112 && (abs(PID) < 11 || abs(PID) > 16)) {
+		return particle[0];
+	}
+	else return 0.0;
+}
+
+// The number of failed comparisons, of which only the first few are
+// printed
+int n_failed = 0;
+const int kMaxPrinted = 20;
+
+// Whether two floats agree to a relative tolerance, or within an absolute
+// one near 0. Two NaNs agree, since the kernels must give NaN where the
+// single-particle functions do.
+bool agree(double a, double b, double tolerance) {
+	if(std::isnan(a) || std::isnan(b)) return std::isnan(a) && std::isnan(b);
+	return std::fabs(a - b) <= tolerance * std::max(1., \
+		std::max(std::fabs(a), std::fabs(b)));
+}
+
+void check(bool ok, const std::string& what, double batch, double scalar) {
+	if(ok) return;
+	if(n_failed++ < kMaxPrinted) {
+		std::cout << "FAILED " << what << ": " << batch << " != " << \
+			scalar << "\n";
+	}
+}
+
+// The particles of one species in one event
+struct TestEvent {
+	std::vector<float> E, px, py, pz;
+	int n() const { return E.size(); }
+	void Add(float e, float x, float y, float z) {
+		E.push_back(e);
+		px.push_back(x);
+		py.push_back(y);
+		pz.push_back(z);
+	}
+	std::vector<float> Particle(int i) const {
+		return {E[i], px[i], py[i], pz[i]};
+	}
+};
+
+// A sentinel that no kernel produces
+const float kUntouched = -12345;
+
+void check_untouched(const std::vector<float>& out, int n, \
+	const std::string& what) {
+	check(out[n] == kUntouched, what + " wrote past the end", out[n], \
+		kUntouched);
+}
+
+// Compare every batch kernel that takes one species with the
+// single-particle functions, for the particles of one event
+void check_event(const TestEvent& event, float Enu, const std::string& name) {
+	int n = event.n();
+	std::vector<float> out(n + 1, kUntouched);
+	const float* E = event.E.data();
+	const float* px = event.px.data();
+	const float* py = event.py.data();
+	const float* pz = event.pz.data();
+	// Tight enough to catch any change of formula, loose enough for
+	// vectorized and scalar code to round differently
+	const double tolerance = 1e-6;
+
+	convenient::kinematics::Theta(px, py, pz, n, out.data());
+	for(int i = 0; i < n; i++) {
+		float scalar = calcTheta(event.Particle(i));
+		check(agree(out[i], scalar, tolerance), name + " theta", out[i], \
+			scalar);
+	}
+	check_untouched(out, n, name + " theta");
+
+	convenient::kinematics::Momentum(px, py, pz, n, out.data());
+	for(int i = 0; i < n; i++) {
+		float scalar = calcMomentum(event.Particle(i));
+		check(agree(out[i], scalar, tolerance), name + " |p|", out[i], \
+			scalar);
+	}
+	check_untouched(out, n, name + " |p|");
+
+	convenient::kinematics::CosTheta(px, py, pz, n, out.data());
+	for(int i = 0; i < n; i++) {
+		float scalar = convenient::kinematics::CosTheta(px[i], py[i], pz[i]);
+		check(agree(out[i], scalar, tolerance), name + " cos(theta)", out[i], \
+			scalar);
+		double reference = TVector3(px[i], py[i], pz[i]).CosTheta();
+		check(agree(scalar, reference, 1e-5), name + " cos(theta) vs " \
+			"TVector3", scalar, reference);
+	}
+	check_untouched(out, n, name + " cos(theta)");
+
+	convenient::kinematics::InvariantMass(E, px, py, pz, n, out.data());
+	for(int i = 0; i < n; i++) {
+		float scalar = calcMass(event.Particle(i));
+		// For a massless particle E^2 - p^2 is 0 up to rounding, so one
+		// of the two may be NaN where the other is a tiny mass
+		bool massless = std::fabs(E[i] * E[i] - (px[i] * px[i] + \
+			py[i] * py[i] + pz[i] * pz[i])) <= 1e-5 * E[i] * E[i];
+		// E^2 - p^2 cancels for a light, fast particle, so the mass is only
+		// good to about a float epsilon of E^2 / m, which the macro and the
+		// kernel round differently
+		double cancellation = 4 * FLT_EPSILON * E[i] * E[i] / scalar;
+		bool ok = agree(out[i], scalar, tolerance) || \
+			(scalar > 0 && std::fabs(out[i] - scalar) <= cancellation) || \
+			(massless && \
+			(std::isnan(out[i]) || out[i] < 1e-2 * E[i]) && \
+			(std::isnan(scalar) || scalar < 1e-2 * E[i]));
+		check(ok, name + " mass", out[i], scalar);
+	}
+	check_untouched(out, n, name + " mass");
+
+	convenient::kinematics::Q2(Enu, E, px, py, pz, n, out.data());
+	for(int i = 0; i < n; i++) {
+		float scalar = convenient::kinematics::Q2(Enu, E[i], px[i], py[i], \
+			pz[i]);
+		check(agree(out[i], scalar, tolerance), name + " Q2", out[i], scalar);
+		// Q2 = -(k - k')^2, with k the neutrino along z
+		double reference = -(TLorentzVector(0, 0, Enu, Enu) - \
+			TLorentzVector(px[i], py[i], pz[i], E[i])).M2();
+		check(agree(scalar, reference, 1e-3), name + " Q2 vs " \
+			"TLorentzVector", scalar, reference);
+	}
+	check_untouched(out, n, name + " Q2");
+}
+
+// Compare Eavail<S> with the sum of addtoEavail over the particles, with
+// the PDG code the species stands for
+template <int S>
+void check_eavail(const TestEvent& event, int pdg, const std::string& name) {
+	float batch = convenient::kinematics::Eavail<S>(event.E.data(), \
+		event.n());
+	float scalar = 0;
+	for(int i = 0; i < event.n(); i++) {
+		scalar += addtoEavail(event.Particle(i), pdg);
+	}
+	check(agree(batch, scalar, 1e-5), name + " Eavail of " + \
+		std::to_string(pdg), batch, scalar);
+}
+
+void check_eavail_all_species(const TestEvent& event, \
+	const std::string& name) {
+	check_eavail<convenient::kProtons>(event, 2212, name);
+	check_eavail<convenient::kAntiprotons>(event, -2212, name);
+	check_eavail<convenient::kNeutrons>(event, 2112, name);
+	check_eavail<convenient::kAntineutrons>(event, -2112, name);
+	check_eavail<convenient::kGammas>(event, 22, name);
+	check_eavail<convenient::kPi0s>(event, 111, name);
+	check_eavail<convenient::kPiPs>(event, 211, name);
+	check_eavail<convenient::kPiMs>(event, -211, name);
+	check_eavail<convenient::kMuons>(event, 13, name);
+	check_eavail<convenient::kElectrons>(event, 11, name);
+	check_eavail<convenient::kTaus>(event, 15, name);
+	check_eavail<convenient::kNus>(event, 14, name);
+}
+
+// Compare the Eavail of particles of mixed species (as for kOthers) with
+// the sum of addtoEavail
+void check_eavail_mixed(const TestEvent& event, const std::vector<int>& pdg, \
+	const std::string& name) {
+	float batch = convenient::kinematics::Eavail(event.E.data(), pdg.data(), \
+		event.n());
+	float scalar = 0;
+	for(int i = 0; i < event.n(); i++) {
+		scalar += addtoEavail(event.Particle(i), pdg[i]);
+	}
+	check(agree(batch, scalar, 1e-5), name + " Eavail of mixed species", \
+		batch, scalar);
+}
+
+// A random event of n particles of the given mass, pointing anywhere
+TestEvent random_event(std::mt19937& rng, int n, float mass) {
+	std::uniform_real_distribution<float> momentum(0, 5);
+	std::uniform_real_distribution<float> cos_theta(-1, 1);
+	std::uniform_real_distribution<float> phi(0, 2 * std::acos(-1.f));
+	TestEvent event;
+	for(int i = 0; i < n; i++) {
+		float p = momentum(rng);
+		float c = cos_theta(rng);
+		float s = std::sqrt(1 - c * c);
+		float f = phi(rng);
+		event.Add(std::sqrt(p * p + mass * mass), p * s * std::cos(f), \
+			p * s * std::sin(f), p * c);
+	}
+	return event;
+}
+
+int main() {
+	// Fixed particles: at rest, along z, against z, across z, massless,
+	// and off shell (E < |p|, so the mass is NaN)
+	TestEvent fixed;
+	fixed.Add(convenient::kProtonMass, 0, 0, 0);
+	fixed.Add(1.2, 0, 0, 0.8);
+	fixed.Add(1.2, 0, 0, -0.8);
+	fixed.Add(0.5, 0.3, -0.4, 0);
+	fixed.Add(2.0, 1.2, 0, 1.6);
+	fixed.Add(0.5, 0.6, 0.2, 0.1);
+	check_event(fixed, 2.0, "fixed");
+	check_eavail_all_species(fixed, "fixed");
+	check_eavail_mixed(fixed, {2212, -211, 1000060120, 3122, -3122, 321}, \
+		"fixed");
+
+	// Empty and one-particle events
+	TestEvent empty;
+	check_event(empty, 2.0, "empty");
+	check_eavail_all_species(empty, "empty");
+	check_eavail_mixed(empty, {}, "empty");
+	for(int i = 0; i < fixed.n(); i++) {
+		TestEvent one;
+		one.Add(fixed.E[i], fixed.px[i], fixed.py[i], fixed.pz[i]);
+		std::string name = "one particle " + std::to_string(i);
+		check_event(one, 2.0, name);
+		check_eavail_all_species(one, name);
+	}
+
+	// Random events, with every number of particles up to 40 (so that the
+	// vectorized loops have remainders of every length) and the masses of
+	// several species
+	std::mt19937 rng(12345);
+	std::uniform_real_distribution<float> Enu(0.1, 20);
+	const std::vector<float> masses = {convenient::kProtonMass, \
+		convenient::kChargedPionMass, convenient::kMuonMass, 0};
+	const std::vector<int> pdgs = {2212, -2212, 2112, -2112, 22, 111, 211, \
+		-211, 13, -13, 11, -11, 15, 14, -14, 321, -321, 3122, -3122, 3222, \
+		1000010010, 1000060120, 2000000101, 0};
+	std::uniform_int_distribution<size_t> pick_pdg(0, pdgs.size() - 1);
+	int n_events = 0;
+	for(int repeat = 0; repeat < 20; repeat++) {
+		for(int n = 0; n <= 40; n++) {
+			for(float mass : masses) {
+				TestEvent event = random_event(rng, n, mass);
+				std::string name = "random event " + std::to_string(n_events);
+				check_event(event, Enu(rng), name);
+				check_eavail_all_species(event, name);
+				std::vector<int> pdg(n);
+				for(int& p : pdg) p = pdgs[pick_pdg(rng)];
+				check_eavail_mixed(event, pdg, name);
+				n_events++;
+			}
+		}
+	}
+
+	if(n_failed > 0) {
+		std::cout << n_failed << " comparisons failed.\n";
+		return 1;
+	}
+	std::cout << "The batch kernels agree with the single-particle " << \
+		"functions for " << n_events + fixed.n() + 2 << " events.\n";
+	return 0;
+}